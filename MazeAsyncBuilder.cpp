@@ -0,0 +1,114 @@
+#include "MazeAsyncBuilder.h"
+#include <stdexcept>
+#include <utility>
+#include "MazeCache.h"
+
+MazeAsyncBuilder::MazeAsyncBuilder()
+    : stopping(false), hasPending(false), running(false), cancelled(false), hasReady(false),
+      generator(1, 1), cache(nullptr) {
+    generator.setCancelFlag(&cancelled);
+    solver.setCancelFlag(&cancelled);
+    worker = std::thread(&MazeAsyncBuilder::workerLoop, this);
+}
+
+MazeAsyncBuilder::~MazeAsyncBuilder() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        cancelled = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void MazeAsyncBuilder::request(const MazeJob& job) {
+    // Checked here so the worker thread never throws
+    if (job.width <= 0 || job.height <= 0 ||
+        job.width > MazeGrid::kMaxDimension || job.height > MazeGrid::kMaxDimension) {
+        throw std::invalid_argument("Invalid maze dimensions");
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pendingJob = job;
+        hasPending = true;
+        cancelled = true;
+    }
+    wake.notify_all();
+}
+
+void MazeAsyncBuilder::cancel() {
+    std::lock_guard<std::mutex> guard(lock);
+    hasPending = false;
+    cancelled = true;
+    // A finished but untaken maze is stale too; its grid stays allocated as
+    // the back buffer of the next build
+    hasReady = false;
+    ready.solution.clear();
+}
+
+bool MazeAsyncBuilder::takeResult(MazeResult& result, MazeJob* job) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!hasReady) return false;
+    std::swap(result.maze, ready.maze);
+    result.solution.swap(ready.solution);
+    if (job) *job = readyJob;
+    hasReady = false;
+    return true;
+}
+
+bool MazeAsyncBuilder::isBusy() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return hasPending || running;
+}
+
+//--------------------------------------------------------------
+void MazeAsyncBuilder::workerLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return stopping || hasPending; });
+        if (stopping) return;
+
+        MazeJob job = pendingJob;
+        hasPending = false;
+        running = true;
+        cancelled = false;
+        guard.unlock();
+        build(job);
+        guard.lock();
+        running = false;
+
+        // Publish only if nothing newer was asked for in the meantime
+        if (!cancelled && !hasPending) {
+            std::swap(ready.maze, building.maze);
+            ready.solution.swap(building.solution);
+            readyJob = job;
+            hasReady = true;
+        }
+    }
+}
+
+void MazeAsyncBuilder::build(const MazeJob& job) {
+    bool cached = cache && cache->get(job, building.maze, building.solution);
+    if (!cached) {
+        generator.setSize(job.width, job.height);
+        generator.setAlgorithm(job.algorithm);
+        if (job.tileSize > 0) {
+            // Runs on the shared pool and is not cancellable mid-way
+            generator.generateTiled(building.maze, job.seed, job.tileSize);
+        } else {
+            generator.generate(building.maze, job.seed);
+        }
+        building.solution.clear();
+    }
+    bool solved = false;
+    if (job.solve && building.solution.empty() && !cancelled) {
+        solver.setAlgorithm(job.solver);
+        solver.solve(building.maze);
+        building.solution = solver.getSolution();
+        solved = true;
+    }
+    if (!job.solve) building.solution.clear();
+    if (cache && !cancelled && (!cached || solved)) {
+        cache->put(job, building.maze, building.solution);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "MazeBatch.h"
+#include "MazeGenerator.h"
+#include "MazeSolver.h"
+
+// Generates and solves one maze at a time on a background thread, so an
+// interactive viewer keeps drawing the current maze while the next is built.
+//
+// request() supersedes whatever is queued or in flight: a running job is
+// cancelled between steps and only the newest job ever completes. The
+// finished maze waits in a back buffer until takeResult() swaps it with the
+// caller's, so no grid is copied and the caller never sees a partial maze.
+class MazeAsyncBuilder {
+public:
+    MazeAsyncBuilder();
+    ~MazeAsyncBuilder();
+    MazeAsyncBuilder(const MazeAsyncBuilder&) = delete;
+    MazeAsyncBuilder& operator=(const MazeAsyncBuilder&) = delete;
+
+    // Queue a job, cancelling any older one. Throws std::invalid_argument
+    // for bad dimensions.
+    void request(const MazeJob& job);
+    // Drop the queued or running job and any finished maze not yet taken,
+    // e.g. when the maze was replaced synchronously
+    void cancel();
+    // Swap the newest finished maze into result, optionally with its job.
+    // Returns false if nothing new is ready.
+    bool takeResult(MazeResult& result, MazeJob* job = nullptr);
+    // A job is queued or running
+    bool isBusy() const;
+    // Take jobs from cache when possible, solving entries stored without a
+    // solution, and add the mazes built. The cache must outlive the builder;
+    // set it before the first request.
+    void setCache(MazeCache* cache) { this->cache = cache; }
+
+private:
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stopping;
+
+    MazeJob pendingJob;
+    bool hasPending;
+    bool running;
+    // Set to abandon the running job; polled by the generator and solver
+    std::atomic<bool> cancelled;
+
+    // Back buffer, owned by the worker while running
+    MazeResult building;
+    // Finished maze waiting for takeResult()
+    MazeResult ready;
+    MazeJob readyJob;
+    bool hasReady;
+
+    MazeGenerator generator;
+    MazeSolver solver;
+    MazeCache* cache;
+
+    void workerLoop();
+    void build(const MazeJob& job);
+};
@@ -0,0 +1,63 @@
+#include "MazeBatch.h"
+#include "MazeCache.h"
+
+namespace {
+const std::vector<std::pair<int, int>> noSolution;
+}
+
+MazeBatch::MazeBatch(MazeThreadPool& pool) : pool(pool), cache(nullptr) {
+    for (unsigned i = 0; i < pool.getThreadCount(); i++) {
+        workspaces.push_back(std::make_unique<Workspace>());
+    }
+}
+
+std::vector<MazeResult> MazeBatch::run(const std::vector<MazeJob>& jobs) {
+    std::vector<MazeResult> results(jobs.size());
+    pool.parallelFor(jobs.size(), [&](size_t index, unsigned worker) {
+        Workspace& workspace = *workspaces[worker];
+        results[index].solution = build(jobs[index], workspace, results[index].maze);
+    });
+    return results;
+}
+
+void MazeBatch::run(const std::vector<MazeJob>& jobs, const Consumer& consume) {
+    pool.parallelFor(jobs.size(), [&](size_t index, unsigned worker) {
+        Workspace& workspace = *workspaces[worker];
+        consume(index, workspace.maze, build(jobs[index], workspace, workspace.maze));
+    });
+}
+
+//--------------------------------------------------------------
+const std::vector<std::pair<int, int>>& MazeBatch::build(const MazeJob& job, Workspace& workspace,
+                                                         MazeGrid& maze) {
+    if (cache && cache->get(job, maze, workspace.cachedSolution)) {
+        if (!job.solve) return noSolution;
+        // Entries stored without a solution are solved below
+        if (!workspace.cachedSolution.empty()) return workspace.cachedSolution;
+    } else {
+        generate(job, workspace, maze);
+    }
+
+    if (!job.solve) {
+        if (cache) cache->put(job, maze, noSolution);
+        return noSolution;
+    }
+    workspace.solver.setAlgorithm(job.solver);
+    workspace.solver.solve(maze);
+    if (cache) cache->put(job, maze, workspace.solver.getSolution());
+    return workspace.solver.getSolution();
+}
+
+void MazeBatch::generate(const MazeJob& job, Workspace& workspace, MazeGrid& maze) {
+    if (!workspace.generator) {
+        workspace.generator = std::make_unique<MazeGenerator>(job.width, job.height);
+    } else {
+        workspace.generator->setSize(job.width, job.height);
+    }
+    workspace.generator->setAlgorithm(job.algorithm);
+    if (job.tileSize > 0) {
+        workspace.generator->generateTiled(maze, job.seed, job.tileSize, pool);
+    } else {
+        workspace.generator->generate(maze, job.seed);
+    }
+}
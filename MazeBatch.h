@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "MazeGenerator.h"
+#include "MazeGrid.h"
+#include "MazeSolver.h"
+#include "MazeThreadPool.h"
+
+class MazeCache;
+
+// One maze to build: size, algorithm and seed fully determine the result.
+struct MazeJob {
+    int width = 20;
+    int height = 20;
+    MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER;
+    uint64_t seed = 0;
+    int tileSize = 0;  // > 0: carve in parallel tiles (see MazeGenerator::generateTiled)
+    bool solve = true;
+    MazeSolver::Algorithm solver = MazeSolver::Algorithm::BFS;
+};
+
+struct MazeResult {
+    MazeGrid maze;
+    std::vector<std::pair<int, int>> solution;
+};
+
+// Generates and solves many independent mazes across a thread pool.
+//
+// Each pool worker keeps its own generator, solver and grid, so after the
+// first few jobs no scratch memory is allocated. Results are identical to
+// running the jobs one by one, whatever the thread count.
+class MazeBatch {
+public:
+    explicit MazeBatch(MazeThreadPool& pool = MazeThreadPool::shared());
+
+    // Results are returned in job order
+    std::vector<MazeResult> run(const std::vector<MazeJob>& jobs);
+
+    // Streaming variant for very large batches: consume(index, maze, solution)
+    // is called on the worker thread as soon as each job finishes, in no
+    // particular order. The grid and solution are only valid during the call.
+    typedef std::function<void(size_t index, const MazeGrid& maze,
+                               const std::vector<std::pair<int, int>>& solution)> Consumer;
+    void run(const std::vector<MazeJob>& jobs, const Consumer& consume);
+
+    MazeThreadPool& getPool() { return pool; }
+    // Serve jobs from cache when possible and add the ones built; nullptr
+    // (the default) disables caching. The cache must outlive the runs.
+    void setCache(MazeCache* cache) { this->cache = cache; }
+
+private:
+    struct Workspace {
+        std::unique_ptr<MazeGenerator> generator;
+        MazeSolver solver;
+        MazeGrid maze;
+        std::vector<std::pair<int, int>> cachedSolution;
+    };
+
+    MazeThreadPool& pool;
+    std::vector<std::unique_ptr<Workspace>> workspaces;
+    MazeCache* cache;
+
+    // Returns the solution, empty unless the job asked for one
+    const std::vector<std::pair<int, int>>& build(const MazeJob& job, Workspace& workspace,
+                                                  MazeGrid& maze);
+    void generate(const MazeJob& job, Workspace& workspace, MazeGrid& maze);
+};
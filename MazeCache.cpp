@@ -0,0 +1,185 @@
+#include "MazeCache.h"
+#include <filesystem>
+#include <stdexcept>
+#include "MazeFile.h"
+
+MazeCache::MazeCache(size_t byteBudget)
+    : byteBudget(byteBudget), byteSize(0), hits(0), misses(0) {}
+
+void MazeCache::setByteBudget(size_t bytes) {
+    std::lock_guard<std::mutex> guard(lock);
+    byteBudget = bytes;
+    evict();
+}
+
+size_t MazeCache::getByteBudget() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return byteBudget;
+}
+
+size_t MazeCache::getByteSize() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return byteSize;
+}
+
+size_t MazeCache::getEntryCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+size_t MazeCache::getHitCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return hits;
+}
+
+size_t MazeCache::getMissCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return misses;
+}
+
+void MazeCache::setDirectory(const std::string& directory) {
+    if (!directory.empty()) std::filesystem::create_directories(directory);
+    std::lock_guard<std::mutex> guard(lock);
+    this->directory = directory;
+}
+
+void MazeCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    index.clear();
+    byteSize = 0;
+}
+
+bool MazeCache::get(const MazeJob& job, MazeGrid& maze,
+                    std::vector<std::pair<int, int>>& solution) {
+    MazeCacheKey key(job);
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            maze = found->second->result.maze;
+            solution = found->second->result.solution;
+            hits++;
+            return true;
+        }
+        if (directory.empty()) {
+            misses++;
+            return false;
+        }
+        path = pathFor(key);
+    }
+
+    // Disk I/O without the lock
+    bool loaded = load(key, path, maze, solution);
+    std::lock_guard<std::mutex> guard(lock);
+    if (!loaded) {
+        misses++;
+        return false;
+    }
+    hits++;
+    if (index.find(key) == index.end()) {
+        insert(key, maze, solution);
+        evict();
+    }
+    return true;
+}
+
+void MazeCache::put(const MazeJob& job, const MazeGrid& maze,
+                    const std::vector<std::pair<int, int>>& solution) {
+    MazeCacheKey key(job);
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            // Same grid by construction; keep whichever solution is known
+            Entry& entry = *found->second;
+            entries.splice(entries.begin(), entries, found->second);
+            if (entry.result.solution.empty() && !solution.empty()) {
+                byteSize -= entry.bytes;
+                entry.result.solution = solution;
+                entry.bytes += solution.size() * sizeof(solution[0]);
+                byteSize += entry.bytes;
+                evict();
+            }
+        } else {
+            insert(key, maze, solution);
+            evict();
+        }
+        if (directory.empty()) return;
+        path = pathFor(key);
+    }
+
+    // save() renames a temporary file into place, so readers in other
+    // processes never map a partial file
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        // Rewrite only to add a solution the stored file lacks
+        if (solution.empty()) return;
+        MazeFile stored;
+        try {
+            stored.open(path);
+            if (stored.hasSolution()) return;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    MazeFile::save(path, maze, static_cast<uint32_t>(job.algorithm), job.seed, solution);
+}
+
+//--------------------------------------------------------------
+void MazeCache::insert(const MazeCacheKey& key, const MazeGrid& maze,
+                       const std::vector<std::pair<int, int>>& solution) {
+    size_t bytes = sizeof(Entry) + maze.getByteSize() + solution.size() * sizeof(solution[0]);
+    // Too big to ever fit; the disk tier may still keep it
+    if (bytes > byteBudget) return;
+    entries.push_front(Entry{key, MazeResult{maze, solution}, bytes});
+    index.emplace(key, entries.begin());
+    byteSize += bytes;
+}
+
+void MazeCache::evict() {
+    while (byteSize > byteBudget && !entries.empty()) {
+        byteSize -= entries.back().bytes;
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+size_t MazeCache::KeyHash::operator()(const MazeCacheKey& key) const {
+    uint64_t h = key.seed * 0x9E3779B97F4A7C15ULL;
+    h ^= static_cast<uint64_t>(key.width) << 40 ^ static_cast<uint64_t>(key.height) << 20 ^
+         static_cast<uint64_t>(key.algorithm) << 12 ^ static_cast<uint64_t>(key.tileSize);
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+std::string MazeCache::pathFor(const MazeCacheKey& key) const {
+    std::string name = std::to_string(key.width) + "x" + std::to_string(key.height) + "-" +
+                       std::to_string(static_cast<int>(key.algorithm)) + "-" +
+                       std::to_string(key.seed);
+    if (key.tileSize > 0) name += "-t" + std::to_string(key.tileSize);
+    return (std::filesystem::path(directory) / (name + ".maze")).string();
+}
+
+bool MazeCache::load(const MazeCacheKey& key, const std::string& path, MazeGrid& maze,
+                     std::vector<std::pair<int, int>>& solution) const {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) return false;
+    MazeFile file;
+    try {
+        file.open(path);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    const MazeFile::Header& header = file.getHeader();
+    if (static_cast<int>(header.width) != key.width || static_cast<int>(header.height) != key.height ||
+        header.algorithm != static_cast<uint32_t>(key.algorithm) || header.seed != key.seed ||
+        !file.verify()) {
+        return false;
+    }
+    // Copy out of the mapping, which closes with the file
+    if (!file.readSolution(solution)) return false;
+    maze = file.getGrid();
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "MazeBatch.h"
+#include "MazeGenerator.h"
+#include "MazeGrid.h"
+
+// What fully determines a generated grid (the solver does not matter: a
+// perfect maze has a single path between entrance and exit)
+struct MazeCacheKey {
+    int width;
+    int height;
+    MazeGenerator::Algorithm algorithm;
+    uint64_t seed;
+    int tileSize;
+
+    explicit MazeCacheKey(const MazeJob& job)
+        : width(job.width), height(job.height), algorithm(job.algorithm), seed(job.seed),
+          tileSize(job.tileSize) {}
+    bool operator==(const MazeCacheKey& other) const {
+        return width == other.width && height == other.height && algorithm == other.algorithm &&
+               seed == other.seed && tileSize == other.tileSize;
+    }
+};
+
+// Generated mazes and their solutions kept by key, so revisiting a size,
+// algorithm and seed costs a copy instead of a generate and solve.
+//
+// The memory tier holds up to a byte budget and evicts the least recently
+// used entries beyond it. With a directory set, every entry is also written
+// there as a MazeFile and memory misses are looked up on disk, so the cache
+// survives restarts and can be shared between processes.
+//
+// Render meshes are not cached: their VBOs belong to the viewer's GL
+// context while the cache is shared with builder threads and the CLI, and
+// they depend on the cell size and wall height as well as the key. The
+// renderer rebuilds them from the cached grid (about 1.5 ms for the
+// viewer's largest 100 x 100 maze).
+//
+// All calls are thread-safe.
+class MazeCache {
+public:
+    static const size_t kDefaultBudget = size_t(64) << 20;
+
+    explicit MazeCache(size_t byteBudget = kDefaultBudget);
+
+    // Evicts down to the new budget at once
+    void setByteBudget(size_t bytes);
+    size_t getByteBudget() const;
+    // Bytes held by the memory tier
+    size_t getByteSize() const;
+    size_t getEntryCount() const;
+    // Disk tier location, created if missing; empty disables it
+    void setDirectory(const std::string& directory);
+
+    // Copy the cached maze for job into maze and solution. Returns false on
+    // a miss. An entry may have been stored without a solution.
+    bool get(const MazeJob& job, MazeGrid& maze, std::vector<std::pair<int, int>>& solution);
+    void put(const MazeJob& job, const MazeGrid& maze,
+             const std::vector<std::pair<int, int>>& solution);
+    // Empty the memory tier; files on disk are kept
+    void clear();
+
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+
+private:
+    struct Entry {
+        MazeCacheKey key;
+        MazeResult result;
+        size_t bytes;
+    };
+    struct KeyHash {
+        size_t operator()(const MazeCacheKey& key) const;
+    };
+
+    mutable std::mutex lock;
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<MazeCacheKey, std::list<Entry>::iterator, KeyHash> index;
+    size_t byteBudget;
+    size_t byteSize;
+    std::string directory;
+    size_t hits;
+    size_t misses;
+
+    // Caller holds the lock
+    void insert(const MazeCacheKey& key, const MazeGrid& maze,
+                const std::vector<std::pair<int, int>>& solution);
+    void evict();
+    std::string pathFor(const MazeCacheKey& key) const;
+    bool load(const MazeCacheKey& key, const std::string& path, MazeGrid& maze,
+              std::vector<std::pair<int, int>>& solution) const;
+};
@@ -0,0 +1,218 @@
+#include "MazeFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "MazeRandom.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(MazeFile::Header) == 64, "MazeFile::Header must stay 64 bytes");
+
+namespace {
+
+const char kMagic[4] = {'M', 'A', 'Z', 'E'};
+const int kStepsPerWord = MazeGrid::kWordBits / 2;
+
+uint64_t fnv1a(uint64_t hash, const MazeGrid::Word* words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hash ^= words[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+const uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+
+size_t solutionWords(uint64_t length) {
+    if (length == 0) return 0;
+    return 1 + static_cast<size_t>((length - 1 + kStepsPerWord - 1) / kStepsPerWord);
+}
+
+void unmap(unsigned char* base, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+}  // namespace
+
+MazeFile::MazeFile() : base(nullptr), size(0) {}
+
+MazeFile::~MazeFile() {
+    close();
+}
+
+bool MazeFile::save(const std::string& path, const MazeGrid& maze, uint32_t algorithm,
+                    uint64_t seed, const std::vector<std::pair<int, int>>& solution) {
+    // Pack the solution first so a bad path is rejected before touching the file
+    std::vector<MazeGrid::Word> packed;
+    if (!solution.empty()) {
+        packed.assign(solutionWords(solution.size()), 0);
+        packed[0] = static_cast<uint32_t>(solution[0].first) |
+                    static_cast<uint64_t>(static_cast<uint32_t>(solution[0].second)) << 32;
+        for (size_t i = 1; i < solution.size(); i++) {
+            int dx = solution[i].first - solution[i - 1].first;
+            int dy = solution[i].second - solution[i - 1].second;
+            int dir = 0;
+            while (dir < 4 && (MazeGrid::kDirX[dir] != dx || MazeGrid::kDirY[dir] != dy)) dir++;
+            if (dir == 4) throw std::invalid_argument("Solution steps must join adjacent slots");
+            size_t step = i - 1;
+            packed[1 + step / kStepsPerWord] |= MazeGrid::Word(dir) << (2 * (step % kStepsPerWord));
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = static_cast<uint32_t>(maze.getWidth());
+    header.height = static_cast<uint32_t>(maze.getHeight());
+    header.algorithm = algorithm;
+    header.seed = seed;
+    header.wordsPerRow = maze.getWordsPerRow();
+    header.solutionLength = solution.size();
+    header.checksum = fnv1a(fnv1a(kFnvOffset, maze.row(0), maze.getWordCount()),
+                            packed.data(), packed.size());
+
+    // Written under a temporary name and renamed over path: maze may view a
+    // mapping of path itself, and readers never map a partial file
+    std::string temporary = path + "." + std::to_string(MazeRandom::randomSeed()) + ".tmp";
+    bool written;
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(maze.row(0)), maze.getByteSize());
+        out.write(reinterpret_cast<const char*>(packed.data()),
+                  packed.size() * sizeof(MazeGrid::Word));
+        out.close();
+        written = static_cast<bool>(out);
+    }
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(temporary, path, error);
+        if (!error) return true;
+    }
+    std::filesystem::remove(temporary, error);
+    return false;
+}
+
+void MazeFile::open(const std::string& path) {
+    // Map and check the new file before letting go of the current one, so a
+    // failed open leaves existing views intact
+    unsigned char* mapped = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open " + path);
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(Header))) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping) {
+            mapped = static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+            mappedSize = static_cast<size_t>(fileSize.QuadPart);
+            // The view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Header))) {
+        void* view = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            mapped = static_cast<unsigned char*>(view);
+            mappedSize = static_cast<size_t>(info.st_size);
+        }
+    }
+    // The mapping keeps the file alive
+    ::close(fd);
+#endif
+    if (!mapped) throw std::runtime_error("Not a valid maze file: " + path);
+
+    const Header& header = *reinterpret_cast<const Header*>(mapped);
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                 header.version == kVersion && header.width > 0 && header.height > 0 &&
+                 header.width <= static_cast<uint32_t>(MazeGrid::kMaxDimension) &&
+                 header.height <= static_cast<uint32_t>(MazeGrid::kMaxDimension) &&
+                 header.wordsPerRow == (2 * header.width + 1 + MazeGrid::kWordBits - 1) / MazeGrid::kWordBits;
+    if (valid) {
+        uint64_t words = header.wordsPerRow * (2 * header.height + 1) +
+                         solutionWords(header.solutionLength);
+        // A path visits each slot at most once
+        uint64_t slots = (2 * uint64_t(header.width) + 1) * (2 * uint64_t(header.height) + 1);
+        valid = header.solutionLength <= slots &&
+                (mappedSize - sizeof(Header)) / sizeof(MazeGrid::Word) >= words;
+    }
+    if (!valid) {
+        unmap(mapped, mappedSize);
+        throw std::runtime_error("Not a valid maze file: " + path);
+    }
+
+    close();
+    base = mapped;
+    size = mappedSize;
+    grid.attach(reinterpret_cast<MazeGrid::Word*>(base + sizeof(Header)),
+                static_cast<int>(header.width), static_cast<int>(header.height));
+}
+
+void MazeFile::close() {
+    if (!base) return;
+    unmap(base, size);
+    base = nullptr;
+    size = 0;
+    grid = MazeGrid();
+}
+
+bool MazeFile::readSolution(std::vector<std::pair<int, int>>& solution) const {
+    solution.clear();
+    if (!hasSolution()) return true;
+    const Header& header = getHeader();
+    const MazeGrid::Word* packed = payload() + header.wordsPerRow * (2 * header.height + 1);
+
+    solution.reserve(header.solutionLength);
+    int x = static_cast<int>(static_cast<uint32_t>(packed[0]));
+    int y = static_cast<int>(static_cast<uint32_t>(packed[0] >> 32));
+    // The checksum does not vouch for the path: every slot must be open.
+    // The bitmap is read directly, as the grid may have been moved out.
+    const MazeGrid::Word* bitmap = payload();
+    int64_t slotWidth = 2 * static_cast<int64_t>(header.width) + 1;
+    int64_t slotHeight = 2 * static_cast<int64_t>(header.height) + 1;
+    for (uint64_t step = 0;; step++) {
+        bool open = x >= 0 && x < slotWidth && y >= 0 && y < slotHeight &&
+                    !(bitmap[y * header.wordsPerRow + x / MazeGrid::kWordBits] >>
+                      (x % MazeGrid::kWordBits) & 1);
+        if (!open) {
+            solution.clear();
+            return false;
+        }
+        solution.push_back({x, y});
+        if (step + 1 >= header.solutionLength) break;
+        int dir = (packed[1 + step / kStepsPerWord] >> (2 * (step % kStepsPerWord))) & 3;
+        x += MazeGrid::kDirX[dir];
+        y += MazeGrid::kDirY[dir];
+    }
+    return true;
+}
+
+bool MazeFile::verify() const {
+    if (!isOpen()) return false;
+    const Header& header = getHeader();
+    size_t words = header.wordsPerRow * (2 * header.height + 1) + solutionWords(header.solutionLength);
+    return fnv1a(kFnvOffset, payload(), words) == header.checksum;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+
+// Compact binary maze file, loaded by memory-mapping it and viewing the
+// wall bitmap in place, so opening a maze costs no parse and no copy.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   Header      64 bytes, see below
+//   Bitmap      wordsPerRow * (2 * height + 1) words, exactly MazeGrid's
+//               row layout including the set padding bits
+//   Solution    optional: one word with the start slot (x | y << 32), then
+//               the steps between consecutive slots as 2-bit directions,
+//               32 per word
+//
+// The checksum is FNV-1a over the bitmap and solution words. It is not
+// checked on open() (that would touch every page); call verify() for it.
+//
+// The mapping is private and writable: edits through getGrid() are
+// copy-on-write and never reach the file.
+class MazeFile {
+public:
+    static const uint32_t kVersion = 1;
+    // Stored as the algorithm of mazes not made by MazeGenerator
+    static const uint32_t kNoAlgorithm = 0xFFFFFFFFu;
+
+    struct Header {
+        char magic[4];  // "MAZE"
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t algorithm;
+        uint32_t flags;  // reserved, 0
+        uint64_t seed;
+        uint64_t wordsPerRow;
+        uint64_t solutionLength;  // slots on the solution path, 0 if none
+        uint64_t checksum;
+        uint64_t reserved;
+    };
+
+    MazeFile();
+    ~MazeFile();
+    MazeFile(const MazeFile&) = delete;
+    MazeFile& operator=(const MazeFile&) = delete;
+
+    // Write maze (and solution, if any) to path, through a temporary file
+    // renamed over it, so maze may view a mapping of path itself. Throws
+    // std::invalid_argument if the solution is not a chain of adjacent
+    // slots; returns false on I/O errors.
+    static bool save(const std::string& path, const MazeGrid& maze, uint32_t algorithm,
+                     uint64_t seed, const std::vector<std::pair<int, int>>& solution = {});
+
+    // Map a file in place of the current one. Throws std::runtime_error if
+    // it cannot be mapped or the header does not describe a valid maze; the
+    // current file then stays open.
+    void open(const std::string& path);
+    // Unmap; grids still viewing the file must not be used afterwards
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    const Header& getHeader() const { return *reinterpret_cast<const Header*>(base); }
+    // View of the mapped bitmap; valid until close(). It may be moved out
+    // (the view moves with it) but then must not outlive this file either.
+    MazeGrid& getGrid() { return grid; }
+    const MazeGrid& getGrid() const { return grid; }
+    bool hasSolution() const { return isOpen() && getHeader().solutionLength > 0; }
+    // Unpack the stored solution into slot coordinates. Returns false, with
+    // solution empty, if the path leaves the grid or crosses a wall.
+    bool readSolution(std::vector<std::pair<int, int>>& solution) const;
+    // Recompute the checksum over the whole payload
+    bool verify() const;
+
+private:
+    unsigned char* base;
+    size_t size;
+    MazeGrid grid;
+
+    const MazeGrid::Word* payload() const {
+        return reinterpret_cast<const MazeGrid::Word*>(base + sizeof(Header));
+    }
+};
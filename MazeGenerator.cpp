@@ -1,95 +1,590 @@
 #include "MazeGenerator.h"
+#include "MazeProfiler.h"
+#include "MazeThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
-MazeGenerator::MazeGenerator(int width, int height) 
-    : mazeWidth(width), mazeHeight(height), animating(false) {
+MazeGenerator::MazeGenerator(int width, int height, Algorithm algorithm, uint64_t seed)
+    : animating(false), current_x(1), current_y(1), unvisited(0),
+      mazeWidth(width), mazeHeight(height), algorithm(algorithm), rng(seed), cancelFlag(nullptr),
+      draws(0), rejectedMoves(0), nextEdge(0), walkX(0), walkY(0), walkStart(0), walkPhase(WalkPhase::SCAN) {
     if (!validateDimensions(width, height)) {
         throw std::invalid_argument("Invalid maze dimensions");
     }
-    directions = {{0, 2}, {2, 0}, {0, -2}, {-2, 0}};
 }
 
-void MazeGenerator::generate(vector<vector<int>>& maze) {
+void MazeGenerator::setSize(int width, int height) {
+    if (!validateDimensions(width, height)) {
+        throw std::invalid_argument("Invalid maze dimensions");
+    }
+    mazeWidth = width;
+    mazeHeight = height;
+    animating = false;
+}
+
+const char* MazeGenerator::getAlgorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::RECURSIVE_BACKTRACKER: return "Recursive Backtracker";
+        case Algorithm::PRIMS: return "Prim's Algorithm";
+        case Algorithm::KRUSKALS: return "Kruskal's Algorithm";
+        case Algorithm::ALDOUS_BRODER: return "Aldous-Broder";
+        case Algorithm::WILSON: return "Wilson's Algorithm";
+        case Algorithm::ELLERS: return "Eller's Algorithm";
+    }
+    return "";
+}
+
+struct MazeGenerator::TileWorker {
+    std::unique_ptr<MazeGenerator> generator;
+    MazeGrid tile;
+    // Counters summed over the tiles this worker carved
+    uint64_t draws = 0;
+    uint64_t rejectedMoves = 0;
+    uint64_t cellsCarved = 0;
+};
+
+MazeGenerator::~MazeGenerator() = default;
+
+void MazeGenerator::generate(MazeGrid& maze) {
+    MAZE_PROFILE_SCOPE("generate");
     // Start with all walls
-    for (int y = 0; y < 2 * mazeHeight + 1; y++) {
-        for (int x = 0; x < 2 * mazeWidth + 1; x++) {
-            maze[y][x] = 1;
+    maze.resize(mazeWidth, mazeHeight);
+    animating = false;
+    changedSlots.clear();
+    carve(maze);
+    openEntranceAndExit(maze);
+    publishCounters(getCarvedCount(maze));
+}
+
+void MazeGenerator::carve(MazeGrid& maze) {
+    // Same start/step pairs as the animation, looped without the dispatch
+    begin(maze);
+    switch (algorithm) {
+        case Algorithm::RECURSIVE_BACKTRACKER:
+            while (stepBacktracker(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::PRIMS:
+            while (stepPrims(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::KRUSKALS:
+            while (stepKruskals(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::ALDOUS_BRODER:
+            while (stepAldousBroder(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::WILSON:
+            while (stepWilson(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::ELLERS:
+            while (stepEllers(maze) && !isCancelled()) {}
+            break;
+    }
+}
+
+void MazeGenerator::begin(MazeGrid& maze) {
+    draws = 0;
+    rejectedMoves = 0;
+    switch (algorithm) {
+        case Algorithm::RECURSIVE_BACKTRACKER:
+            startBacktracker(maze);
+            break;
+        case Algorithm::PRIMS:
+            startPrims(maze);
+            break;
+        case Algorithm::KRUSKALS:
+            startKruskals(maze);
+            break;
+        case Algorithm::ALDOUS_BRODER:
+            startAldousBroder(maze);
+            break;
+        case Algorithm::WILSON:
+            startWilson(maze);
+            break;
+        case Algorithm::ELLERS:
+            startEllers();
+            break;
+    }
+}
+
+void MazeGenerator::generate(MazeGrid& maze, uint64_t seed) {
+    rng.setSeed(seed);
+    generate(maze);
+}
+
+void MazeGenerator::generateTiled(MazeGrid& maze, uint64_t seed, int tileSize) {
+    generateTiled(maze, seed, tileSize, MazeThreadPool::shared());
+}
+
+void MazeGenerator::generateTiled(MazeGrid& maze, uint64_t seed, int tileSize,
+                                  MazeThreadPool& pool) {
+    MAZE_PROFILE_SCOPE("generate tiled");
+    // Tiles start on multiples of 32 cells = 64 slots, so each tile owns
+    // whole words of the shared grid and workers never touch the same word.
+    tileSize = std::max(32, (tileSize + 31) / 32 * 32);
+    int tilesX = (mazeWidth + tileSize - 1) / tileSize;
+    int tilesY = (mazeHeight + tileSize - 1) / tileSize;
+    maze.resize(mazeWidth, mazeHeight);
+    animating = false;
+
+    while (tileWorkers.size() < pool.getThreadCount()) {
+        tileWorkers.push_back(std::make_unique<TileWorker>());
+    }
+    for (auto& tileWorker : tileWorkers) {
+        tileWorker->draws = tileWorker->rejectedMoves = tileWorker->cellsCarved = 0;
+    }
+
+    pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, [&](size_t index, unsigned worker) {
+        int tx = static_cast<int>(index % tilesX);
+        int ty = static_cast<int>(index / tilesX);
+        int x0 = tx * tileSize;
+        int y0 = ty * tileSize;
+        int w = std::min(tileSize, mazeWidth - x0);
+        int h = std::min(tileSize, mazeHeight - y0);
+
+        TileWorker& tileWorker = *tileWorkers[worker];
+        if (!tileWorker.generator) {
+            tileWorker.generator = std::make_unique<MazeGenerator>(w, h, algorithm);
+        }
+        MazeGenerator& tileGenerator = *tileWorker.generator;
+        tileGenerator.setSize(w, h);
+        tileGenerator.setAlgorithm(algorithm);
+        tileGenerator.rng.setSeed(MazeRandom(seed ^ (0xD1B54A32D192ED03ull * (index + 1))).next());
+        tileWorker.tile.resize(w, h);
+        tileGenerator.carve(tileWorker.tile);
+        tileWorker.draws += tileGenerator.draws;
+        tileWorker.rejectedMoves += tileGenerator.rejectedMoves;
+        tileWorker.cellsCarved += tileGenerator.getCarvedCount(tileWorker.tile);
+
+        // Copy the tile without its east and south border, which belong
+        // to the neighbouring tiles (or stay walls at the maze edge)
+        size_t words = (2 * static_cast<size_t>(w) + MazeGrid::kWordBits - 1) / MazeGrid::kWordBits;
+        size_t wordOffset = 2 * static_cast<size_t>(x0) / MazeGrid::kWordBits;
+        for (int y = 0; y < 2 * h; y++) {
+            std::memcpy(maze.row(2 * y0 + y) + wordOffset, tileWorker.tile.row(y),
+                        words * sizeof(MazeGrid::Word));
+        }
+    });
+
+    // Join tiles: one random door per shared border, kept only if it links
+    // two tile groups that are not connected yet (Kruskal over tiles)
+    rng.setSeed(seed);
+    draws = 0;
+    rejectedMoves = 0;
+    edges.clear();
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            uint32_t tile = static_cast<uint32_t>(ty * tilesX + tx);
+            if (tx + 1 < tilesX) edges.push_back(tile * 2);
+            if (ty + 1 < tilesY) edges.push_back(tile * 2 + 1);
         }
     }
-    
-    // Start at a random cell
-    current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-    current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-    maze[current_y][current_x] = 0;
-    
-    unvisited = mazeWidth * mazeHeight - 1;
-    
-    while (unvisited > 0) {
-        // Pick a random direction
-        int dir_idx = static_cast<int>(ofRandom(4));
-        int dx = directions[dir_idx].first;
-        int dy = directions[dir_idx].second;
-        int next_x = current_x + dx;
-        int next_y = current_y + dy;
-        
-        if (isValid(next_x, next_y) && maze[next_y][next_x] == 1) {
-            maze[(current_y + next_y) / 2][(current_x + next_x) / 2] = 0;
-            maze[next_y][next_x] = 0;
-            unvisited--;
-            current_x = next_x;
-            current_y = next_y;
+    for (size_t i = edges.size(); i > 1; i--) {
+        std::swap(edges[i - 1], edges[randomInt(static_cast<int>(i))]);
+    }
+    setParent.resize(static_cast<size_t>(tilesX) * tilesY);
+    for (size_t i = 0; i < setParent.size(); i++) {
+        setParent[i] = static_cast<uint32_t>(i);
+    }
+    setRank.assign(setParent.size(), 0);
+
+    for (uint32_t edge : edges) {
+        uint32_t tile = edge / 2;
+        bool south = edge & 1;
+        uint32_t a = findSet(tile);
+        uint32_t b = findSet(tile + (south ? tilesX : 1));
+        if (a == b) continue;
+        if (setRank[a] < setRank[b]) std::swap(a, b);
+        setParent[b] = a;
+        if (setRank[a] == setRank[b]) setRank[a]++;
+
+        int x0 = static_cast<int>(tile % tilesX) * tileSize;
+        int y0 = static_cast<int>(tile / tilesX) * tileSize;
+        if (south) {
+            int span = std::min(tileSize, mazeWidth - x0);
+            maze.carve(2 * (x0 + randomInt(span)) + 1, 2 * (y0 + tileSize));
         } else {
-            do {
-                current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-                current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-            } while (maze[current_y][current_x] == 1);
+            int span = std::min(tileSize, mazeHeight - y0);
+            maze.carve(2 * (x0 + tileSize), 2 * (y0 + randomInt(span)) + 1);
         }
     }
-    
-    // Create entrance and exit
-    maze[0][1] = 0;
-    maze[2 * mazeHeight][2 * mazeWidth - 1] = 0;
-    maze[1][1] = 0;
-    maze[2 * mazeHeight - 1][2 * mazeWidth - 1] = 0;
-}
-
-void MazeGenerator::updateAnimation(vector<vector<int>>& maze) {
-    if (!animating || unvisited <= 0) return;
-    
-    int dir_idx = static_cast<int>(ofRandom(4));
-    int dx = directions[dir_idx].first;
-    int dy = directions[dir_idx].second;
-    int next_x = current_x + dx;
-    int next_y = current_y + dy;
-    
-    if (isValid(next_x, next_y) && maze[next_y][next_x] == 1) {
-        maze[(current_y + next_y) / 2][(current_x + next_x) / 2] = 0;
-        maze[next_y][next_x] = 0;
+
+    openEntranceAndExit(maze);
+    uint64_t cellsCarved = 0;
+    for (const auto& tileWorker : tileWorkers) {
+        draws += tileWorker->draws;
+        rejectedMoves += tileWorker->rejectedMoves;
+        cellsCarved += tileWorker->cellsCarved;
+    }
+    publishCounters(cellsCarved);
+}
+
+bool MazeGenerator::step(MazeGrid& maze) {
+    if (!animating) return false;
+
+    bool more = false;
+    switch (algorithm) {
+        case Algorithm::RECURSIVE_BACKTRACKER:
+            more = stepBacktracker(maze);
+            break;
+        case Algorithm::PRIMS:
+            more = stepPrims(maze);
+            break;
+        case Algorithm::KRUSKALS:
+            more = stepKruskals(maze);
+            break;
+        case Algorithm::ALDOUS_BRODER:
+            more = stepAldousBroder(maze);
+            break;
+        case Algorithm::WILSON:
+            more = stepWilson(maze);
+            break;
+        case Algorithm::ELLERS:
+            more = stepEllers(maze);
+            break;
+    }
+    if (!more) {
+        openEntranceAndExit(maze);
+        changedSlots.emplace_back(1, 0);
+        changedSlots.emplace_back(2 * mazeWidth - 1, 2 * mazeHeight);
+        animating = false;
+        publishCounters(getCarvedCount(maze));
+    }
+    return more;
+}
+
+void MazeGenerator::reset(MazeGrid& maze) {
+    maze.resize(mazeWidth, mazeHeight);
+    changedSlots.clear();
+    animating = true;
+    begin(maze);
+}
+
+void MazeGenerator::reset(MazeGrid& maze, uint64_t seed) {
+    rng.setSeed(seed);
+    reset(maze);
+}
+
+//--------------------------------------------------------------
+void MazeGenerator::openCell(MazeGrid& maze, int cx, int cy) {
+    maze.carve(2 * cx + 1, 2 * cy + 1);
+    if (animating) changedSlots.emplace_back(2 * cx + 1, 2 * cy + 1);
+    current_x = 2 * cx + 1;
+    current_y = 2 * cy + 1;
+}
+
+void MazeGenerator::openPassage(MazeGrid& maze, int cx, int cy, int dir) {
+    // Opens the wall towards dir and the neighbour, which becomes current
+    int wx = 2 * cx + 1 + MazeGrid::kDirX[dir];
+    int wy = 2 * cy + 1 + MazeGrid::kDirY[dir];
+    maze.carve(wx, wy);
+    if (animating) changedSlots.emplace_back(wx, wy);
+    openCell(maze, cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir]);
+}
+
+void MazeGenerator::startBacktracker(MazeGrid& maze) {
+    startAt(maze, randomInt(mazeWidth), randomInt(mazeHeight));
+}
+
+void MazeGenerator::startAt(MazeGrid& maze, int cx, int cy) {
+    stack.clear();
+    stack.push_back(static_cast<uint32_t>(maze.cellIndex(cx, cy)));
+    openCell(maze, cx, cy);
+    unvisited = mazeWidth * mazeHeight - 1;
+}
+
+bool MazeGenerator::stepBacktracker(MazeGrid& maze) {
+    // Every cell is pushed and popped once and scans at most four
+    // neighbours each time it is on top, so the whole run is O(cells).
+    while (!stack.empty()) {
+        uint32_t cell = stack.back();
+        int cx = cell % mazeWidth;
+        int cy = cell / mazeWidth;
+
+        int candidates[4];
+        int count = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            if (maze.hasNeighbor(cx, cy, dir) &&
+                !maze.isCellVisited(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir])) {
+                candidates[count++] = dir;
+            }
+        }
+
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        int dir = candidates[count == 1 ? 0 : randomInt(count)];
+        openPassage(maze, cx, cy, dir);
+        stack.push_back(static_cast<uint32_t>(
+            maze.cellIndex(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir])));
+        unvisited--;
+        return true;
+    }
+    return false;
+}
+
+void MazeGenerator::startPrims(MazeGrid& maze) {
+    // Frontier is an unordered flat array: a random pick is swapped with
+    // the last element and popped, so each cell costs O(1) to add/remove.
+    frontier.clear();
+    inFrontier.assign(maze.getCellCount(), 0);
+
+    int cx = randomInt(mazeWidth);
+    int cy = randomInt(mazeHeight);
+    openCell(maze, cx, cy);
+    addFrontier(maze, cx, cy);
+    unvisited = mazeWidth * mazeHeight - 1;
+}
+
+bool MazeGenerator::stepPrims(MazeGrid& maze) {
+    if (frontier.empty()) return false;
+    size_t pick = randomInt(static_cast<int>(frontier.size()));
+    uint32_t cell = frontier[pick];
+    frontier[pick] = frontier.back();
+    frontier.pop_back();
+    int cx = cell % mazeWidth;
+    int cy = cell / mazeWidth;
+
+    // Connect to a random neighbour that is already in the maze
+    int candidates[4];
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        if (maze.hasNeighbor(cx, cy, dir) &&
+            maze.isCellVisited(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir])) {
+            candidates[count++] = dir;
+        }
+    }
+    int dir = candidates[count == 1 ? 0 : randomInt(count)];
+    openPassage(maze, cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir],
+                MazeGrid::opposite(dir));
+    unvisited--;
+    addFrontier(maze, cx, cy);
+    return !frontier.empty();
+}
+
+void MazeGenerator::addFrontier(const MazeGrid& maze, int cx, int cy) {
+    for (int dir = 0; dir < 4; dir++) {
+        if (!maze.hasNeighbor(cx, cy, dir)) continue;
+        int nx = cx + MazeGrid::kDirX[dir];
+        int ny = cy + MazeGrid::kDirY[dir];
+        size_t index = maze.cellIndex(nx, ny);
+        if (!inFrontier[index] && !maze.isCellVisited(nx, ny)) {
+            inFrontier[index] = 1;
+            frontier.push_back(static_cast<uint32_t>(index));
+        }
+    }
+}
+
+void MazeGenerator::startKruskals(MazeGrid& maze) {
+    size_t cellCount = maze.getCellCount();
+
+    // Flat list of every interior edge, shuffled up front
+    edges.clear();
+    edges.reserve(2 * cellCount);
+    for (int cy = 0; cy < mazeHeight; cy++) {
+        for (int cx = 0; cx < mazeWidth; cx++) {
+            uint32_t cell = static_cast<uint32_t>(maze.cellIndex(cx, cy));
+            if (cx + 1 < mazeWidth) edges.push_back(cell * 2);
+            if (cy + 1 < mazeHeight) edges.push_back(cell * 2 + 1);
+        }
+    }
+    for (size_t i = edges.size(); i > 1; i--) {
+        std::swap(edges[i - 1], edges[randomInt(static_cast<int>(i))]);
+    }
+
+    setParent.resize(cellCount);
+    for (size_t i = 0; i < cellCount; i++) {
+        setParent[i] = static_cast<uint32_t>(i);
+    }
+    setRank.assign(cellCount, 0);
+
+    openCell(maze, 0, 0);
+    unvisited = mazeWidth * mazeHeight - 1;
+    nextEdge = 0;
+}
+
+bool MazeGenerator::stepKruskals(MazeGrid& maze) {
+    // One step joins two trees; edges inside a tree are skipped for free
+    while (nextEdge < edges.size() && unvisited > 0) {
+        uint32_t edge = edges[nextEdge++];
+        uint32_t cell = edge / 2;
+        int dir = (edge & 1) ? MazeGrid::SOUTH : MazeGrid::EAST;
+        uint32_t neighbor = cell + (dir == MazeGrid::SOUTH ? mazeWidth : 1);
+
+        uint32_t a = findSet(cell);
+        uint32_t b = findSet(neighbor);
+        if (a == b) continue;
+
+        // Union by rank
+        if (setRank[a] < setRank[b]) std::swap(a, b);
+        setParent[b] = a;
+        if (setRank[a] == setRank[b]) setRank[a]++;
+
+        int cx = cell % mazeWidth;
+        int cy = cell / mazeWidth;
+        openCell(maze, cx, cy);
+        openPassage(maze, cx, cy, dir);
+        unvisited--;
+        return unvisited > 0;
+    }
+    return false;
+}
+
+uint32_t MazeGenerator::findSet(uint32_t cell) {
+    // Path halving: every visited node is re-pointed to its grandparent
+    while (setParent[cell] != cell) {
+        setParent[cell] = setParent[setParent[cell]];
+        cell = setParent[cell];
+    }
+    return cell;
+}
+
+void MazeGenerator::startAldousBroder(MazeGrid& maze) {
+    // Unbiased but only expected-time: the walk has to cover the grid.
+    walkX = randomInt(mazeWidth);
+    walkY = randomInt(mazeHeight);
+    openCell(maze, walkX, walkY);
+    unvisited = mazeWidth * mazeHeight - 1;
+}
+
+bool MazeGenerator::stepAldousBroder(MazeGrid& maze) {
+    // One step is one move of the walk
+    if (unvisited == 0) return false;
+    int dir = randomInt(4);
+    if (!maze.hasNeighbor(walkX, walkY, dir)) {
+        rejectedMoves++;
+        return true;
+    }
+    int nx = walkX + MazeGrid::kDirX[dir];
+    int ny = walkY + MazeGrid::kDirY[dir];
+    if (!maze.isCellVisited(nx, ny)) {
+        openPassage(maze, walkX, walkY, dir);
         unvisited--;
-        current_x = next_x;
-        current_y = next_y;
     } else {
-        do {
-            current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-            current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-        } while (maze[current_y][current_x] == 1);
-    }
-    
-    if (unvisited <= 0) {
-        maze[0][1] = 0;
-        maze[2 * mazeHeight][2 * mazeWidth - 1] = 0;
-        maze[1][1] = 0;
-        maze[2 * mazeHeight - 1][2 * mazeWidth - 1] = 0;
-        animating = false;
+        rejectedMoves++;
+        current_x = 2 * nx + 1;
+        current_y = 2 * ny + 1;
     }
+    walkX = nx;
+    walkY = ny;
+    return unvisited > 0;
 }
 
-void MazeGenerator::reset() {
-    current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-    current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
+void MazeGenerator::startWilson(MazeGrid& maze) {
+    // Unbiased; each loop-erased walk overwrites walkDir as it revisits
+    // cells, so only the final loop-free route gets carved.
+    walkDir.assign(maze.getCellCount(), 0);
+    openCell(maze, randomInt(mazeWidth), randomInt(mazeHeight));
     unvisited = mazeWidth * mazeHeight - 1;
-    animating = true;
+    walkStart = 0;
+    walkPhase = WalkPhase::SCAN;
+}
+
+bool MazeGenerator::stepWilson(MazeGrid& maze) {
+    // One step is one move of the random walk or one carved cell
+    if (walkPhase == WalkPhase::SCAN) {
+        // Next cell that is not in the tree yet starts a walk
+        size_t cellCount = maze.getCellCount();
+        while (walkStart < cellCount && unvisited > 0) {
+            int sx = static_cast<int>(walkStart % mazeWidth);
+            int sy = static_cast<int>(walkStart / mazeWidth);
+            if (!maze.isCellVisited(sx, sy)) break;
+            walkStart++;
+        }
+        if (walkStart >= cellCount || unvisited == 0) return false;
+        walkX = static_cast<int>(walkStart % mazeWidth);
+        walkY = static_cast<int>(walkStart / mazeWidth);
+        walkPhase = WalkPhase::WALK;
+    }
+
+    if (walkPhase == WalkPhase::WALK) {
+        // Random walk until the tree is hit
+        // Every move counts as rejected until carving takes it back, which
+        // leaves the off-grid draws and the moves erased with loops
+        int dir = randomInt(4);
+        while (!maze.hasNeighbor(walkX, walkY, dir)) {
+            rejectedMoves++;
+            dir = randomInt(4);
+        }
+        rejectedMoves++;
+        walkDir[maze.cellIndex(walkX, walkY)] = static_cast<uint8_t>(dir);
+        walkX += MazeGrid::kDirX[dir];
+        walkY += MazeGrid::kDirY[dir];
+        current_x = 2 * walkX + 1;
+        current_y = 2 * walkY + 1;
+        if (maze.isCellVisited(walkX, walkY)) {
+            // Retrace the loop-erased path from the start
+            walkX = static_cast<int>(walkStart % mazeWidth);
+            walkY = static_cast<int>(walkStart / mazeWidth);
+            walkPhase = WalkPhase::CARVE;
+        }
+        return true;
+    }
+
+    // CARVE: add one cell of the loop-erased path to the tree
+    int dir = walkDir[maze.cellIndex(walkX, walkY)];
+    openCell(maze, walkX, walkY);
+    int wx = 2 * walkX + 1 + MazeGrid::kDirX[dir];
+    int wy = 2 * walkY + 1 + MazeGrid::kDirY[dir];
+    maze.carve(wx, wy);
+    if (animating) changedSlots.emplace_back(wx, wy);
+    unvisited--;
+    rejectedMoves--;
+    walkX += MazeGrid::kDirX[dir];
+    walkY += MazeGrid::kDirY[dir];
+    if (maze.isCellVisited(walkX, walkY)) {
+        walkPhase = WalkPhase::SCAN;
+        return unvisited > 0;
+    }
+    return true;
+}
+
+void MazeGenerator::startEllers() {
+    stream.reset(mazeWidth, rng.next());
+    stream.setOpenings(false);
+}
+
+bool MazeGenerator::stepEllers(MazeGrid& maze) {
+    // One step is one row; the stream's rows use the grid layout, so each
+    // one is a straight copy
+    if (stream.isFinished()) return false;
+    stream.nextRow([&](int64_t slotY, const MazeGrid::Word* row) {
+        int y = static_cast<int>(slotY);
+        std::memcpy(maze.row(y), row, maze.getWordsPerRow() * sizeof(MazeGrid::Word));
+        if (!animating) return;
+        for (int x = 0; x < maze.getSlotWidth(); x++) {
+            if (maze.isOpen(x, y)) changedSlots.emplace_back(x, y);
+        }
+        current_x = 1;
+        current_y = y;
+    }, stream.getRowCount() == mazeHeight - 1);
+    return !stream.isFinished();
+}
+
+//--------------------------------------------------------------
+void MazeGenerator::openEntranceAndExit(MazeGrid& maze) {
+    maze.carve(1, 0);
+    maze.carve(2 * mazeWidth - 1, 2 * mazeHeight);
+    maze.carve(1, 1);
+    maze.carve(2 * mazeWidth - 1, 2 * mazeHeight - 1);
+}
+
+void MazeGenerator::publishCounters(uint64_t cellsCarved) const {
+    MAZE_PROFILE_SET(RNG_DRAWS, draws);
+    MAZE_PROFILE_SET(WALK_REJECTS, rejectedMoves);
+    MAZE_PROFILE_SET(CELLS_CARVED, cellsCarved);
+    (void)cellsCarved;  // unused when MAZE_PROFILE is 0
+}
+
+uint64_t MazeGenerator::getCarvedCount(const MazeGrid& maze) const {
+    // Eller's rows come out of the stream whole
+    if (algorithm == Algorithm::ELLERS) return maze.getCellCount();
+    return maze.getCellCount() - static_cast<uint64_t>(unvisited);
 }
 
-bool MazeGenerator::isValid(int x, int y) const {
-    return x > 0 && x < 2 * mazeWidth && y > 0 && y < 2 * mazeHeight;
+int MazeGenerator::randomInt(int n) {
+    draws++;
+    return static_cast<int>(rng.nextBounded(static_cast<uint32_t>(n)));
 }
@@ -1,29 +1,148 @@
 #pragma once
-#include "ofMain.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+#include "MazeRandom.h"
+#include "MazeStream.h"
+
+class MazeThreadPool;
 
 class MazeGenerator {
 public:
-    MazeGenerator(int width, int height);
-    void generate(vector<vector<int>>& maze);
+    enum class Algorithm {
+        RECURSIVE_BACKTRACKER,  // explicit-stack DFS, linear time
+        PRIMS,                  // randomized Prim's, flat frontier array
+        KRUSKALS,               // randomized Kruskal's, union-find over shuffled edges
+        ALDOUS_BRODER,          // uniform spanning tree, random walk
+        WILSON,                 // uniform spanning tree, loop-erased walks
+        ELLERS                  // row by row, O(width) state (see MazeStream)
+    };
+
+    MazeGenerator(int width, int height, Algorithm algorithm = Algorithm::RECURSIVE_BACKTRACKER,
+                  uint64_t seed = 0);
+    ~MazeGenerator();
+
+    // Change the maze size while keeping scratch buffers for reuse
+    void setSize(int width, int height);
+    int getWidth() const { return mazeWidth; }
+    int getHeight() const { return mazeHeight; }
+    void setAlgorithm(Algorithm algorithm) { this->algorithm = algorithm; }
+    Algorithm getAlgorithm() const { return algorithm; }
+    static const char* getAlgorithmName(Algorithm algorithm);
+
+    // Generate with the engine's current state, or reseed first so the
+    // result depends only on (width, height, algorithm, seed).
+    void generate(MazeGrid& maze);
+    void generate(MazeGrid& maze, uint64_t seed);
+    // Split the maze into tiles of tileSize cells (rounded up to a multiple
+    // of 32), carve every tile as its own spanning tree in parallel, then
+    // join the tiles through a random spanning tree over their borders so
+    // the result is still a perfect maze. Deterministic for a given seed
+    // regardless of the thread count.
+    void generateTiled(MazeGrid& maze, uint64_t seed, int tileSize = 512);
+    void generateTiled(MazeGrid& maze, uint64_t seed, int tileSize, MazeThreadPool& pool);
+    MazeRandom& getRandom() { return rng; }
+    uint64_t getSeed() const { return rng.getSeed(); }
+    // generate() stops early, leaving the grid unfinished, once *flag is
+    // set, so a background build can be abandoned (nullptr disables)
+    void setCancelFlag(const std::atomic<bool>* flag) { cancelFlag = flag; }
+
+    // Incremental generation for any algorithm: reset() clears the grid and
+    // starts a run, each step() does one small unit of work (one carved
+    // cell, one walk move, one Kruskal union or one Eller row) and returns
+    // false once the maze is complete. The result is identical to
+    // generate() with the same seed.
+    void reset(MazeGrid& maze);
+    void reset(MazeGrid& maze, uint64_t seed);
+    bool step(MazeGrid& maze);
     bool isAnimating() const { return animating; }
-    void updateAnimation(vector<vector<int>>& maze);
-    void reset();
-    
+    // Slots opened by step() since the last clear, so viewers can
+    // patch just those instead of redrawing the whole grid
+    const std::vector<std::pair<int, int>>& getChangedSlots() const { return changedSlots; }
+    void clearChangedSlots() { changedSlots.clear(); }
+
     // Animation properties
     bool animating;
     int current_x;
     int current_y;
     int unvisited;
-    vector<pair<int, int>> directions;
 
 private:
     int mazeWidth;
     int mazeHeight;
-    bool isValid(int x, int y) const;
-    ~MazeGenerator() = default;
-    
+    Algorithm algorithm;
+    MazeRandom rng;
+    const std::atomic<bool>* cancelFlag;
+    // Random numbers drawn and random-walk moves that carved nothing this
+    // run, for the profiler
+    uint64_t draws;
+    uint64_t rejectedMoves;
+
+    // Backtracker stack of cell indices, kept between runs to avoid reallocating
+    std::vector<uint32_t> stack;
+    // Wilson's pending walk direction per cell
+    std::vector<uint8_t> walkDir;
+    // Prim's frontier cells and membership flags
+    std::vector<uint32_t> frontier;
+    std::vector<uint8_t> inFrontier;
+    // Kruskal's edge list (cell * 2 + {0: east, 1: south}) and disjoint sets
+    std::vector<uint32_t> edges;
+    std::vector<uint32_t> setParent;
+    std::vector<uint8_t> setRank;
+    // Kruskal's next edge to examine
+    size_t nextEdge;
+    // Aldous-Broder / Wilson walker, Wilson's scan position and phase
+    enum class WalkPhase { SCAN, WALK, CARVE };
+    int walkX;
+    int walkY;
+    size_t walkStart;
+    WalkPhase walkPhase;
+    // Eller's row generator
+    MazeStream stream;
+    std::vector<std::pair<int, int>> changedSlots;
+    // Per-worker generators and tile grids for generateTiled
+    struct TileWorker;
+    std::vector<std::unique_ptr<TileWorker>> tileWorkers;
+
+    // Carve the selected algorithm into an all-wall grid, no entrance/exit
+    void carve(MazeGrid& maze);
+    // Per-algorithm state machines: start carves the first cell, each step
+    // returns false once the algorithm is done
+    void begin(MazeGrid& maze);
+    void startBacktracker(MazeGrid& maze);
+    void startAt(MazeGrid& maze, int cx, int cy);
+    bool stepBacktracker(MazeGrid& maze);
+    void startPrims(MazeGrid& maze);
+    bool stepPrims(MazeGrid& maze);
+    void startKruskals(MazeGrid& maze);
+    bool stepKruskals(MazeGrid& maze);
+    void startAldousBroder(MazeGrid& maze);
+    bool stepAldousBroder(MazeGrid& maze);
+    void startWilson(MazeGrid& maze);
+    bool stepWilson(MazeGrid& maze);
+    void startEllers();
+    bool stepEllers(MazeGrid& maze);
+    // Carve helpers that track the current slot and, while animating, the
+    // changed slots
+    void openCell(MazeGrid& maze, int cx, int cy);
+    void openPassage(MazeGrid& maze, int cx, int cy, int dir);
+    void openEntranceAndExit(MazeGrid& maze);
+    // Report this run's counters to the profiler
+    void publishCounters(uint64_t cellsCarved) const;
+    uint64_t getCarvedCount(const MazeGrid& maze) const;
+    bool isCancelled() const {
+        return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+    }
+    void addFrontier(const MazeGrid& maze, int cx, int cy);
+    uint32_t findSet(uint32_t cell);
+    int randomInt(int n);
+
     // Validate maze dimensions
     static bool validateDimensions(int width, int height) {
-        return width > 0 && height > 0 && width < 1000 && height < 1000;
+        return width > 0 && height > 0 &&
+               width <= MazeGrid::kMaxDimension && height <= MazeGrid::kMaxDimension;
     }
 };
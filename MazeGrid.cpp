@@ -0,0 +1,67 @@
+#include "MazeGrid.h"
+#include <algorithm>
+#include <utility>
+
+const int MazeGrid::kDirX[4] = {0, 1, 0, -1};
+const int MazeGrid::kDirY[4] = {-1, 0, 1, 0};
+
+MazeGrid::MazeGrid() : width(0), height(0), wordsPerRow(0), bits(nullptr) {}
+
+MazeGrid::MazeGrid(int width, int height) : MazeGrid() {
+    resize(width, height);
+}
+
+MazeGrid::MazeGrid(const MazeGrid& other) : MazeGrid() {
+    *this = other;
+}
+
+MazeGrid::MazeGrid(MazeGrid&& other) noexcept : MazeGrid() {
+    *this = std::move(other);
+}
+
+MazeGrid& MazeGrid::operator=(const MazeGrid& other) {
+    if (this == &other) return *this;
+    width = other.width;
+    height = other.height;
+    wordsPerRow = other.wordsPerRow;
+    words.assign(other.bits, other.bits + other.getWordCount());
+    bits = words.empty() ? nullptr : words.data();
+    return *this;
+}
+
+MazeGrid& MazeGrid::operator=(MazeGrid&& other) noexcept {
+    if (this == &other) return *this;
+    width = other.width;
+    height = other.height;
+    wordsPerRow = other.wordsPerRow;
+    words = std::move(other.words);
+    // A moved vector keeps its buffer, and a view keeps pointing at the
+    // external memory
+    bits = other.bits;
+    other.words.clear();
+    other.width = 0;
+    other.height = 0;
+    other.wordsPerRow = 0;
+    other.bits = nullptr;
+    return *this;
+}
+
+void MazeGrid::resize(int width, int height) {
+    this->width = width;
+    this->height = height;
+    wordsPerRow = (getSlotWidth() + kWordBits - 1) / kWordBits;
+    words.assign(wordsPerRow * getSlotHeight(), ~Word(0));
+    bits = words.data();
+}
+
+void MazeGrid::fill(bool wall) {
+    std::fill(bits, bits + getWordCount(), wall ? ~Word(0) : Word(0));
+}
+
+void MazeGrid::attach(Word* bits, int width, int height) {
+    std::vector<Word>().swap(words);
+    this->width = width;
+    this->height = height;
+    wordsPerRow = (getSlotWidth() + kWordBits - 1) / kWordBits;
+    this->bits = bits;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packed wall bitmap shared by the generator, solver and renderer.
+//
+// The maze is addressed in "slot" coordinates: a (2W+1)x(2H+1) grid where the
+// odd/odd slots are cells and the remaining slots are the walls between them.
+// Every slot is a single bit (1 = wall, 0 = open). Rows are padded to whole
+// 64-bit words and stored back to back in one allocation, so a row is a plain
+// word pointer and a 1000x1000 maze takes about 500 KB.
+//
+// A grid can also view memory it does not own (e.g. a mapped maze file, see
+// MazeFile) in the same layout; copies of a view own their words.
+class MazeGrid {
+public:
+    typedef uint64_t Word;
+    static const int kWordBits = 64;
+    static const int kMaxDimension = 1 << 15;  // cells per side
+
+    enum Direction { NORTH = 0, EAST = 1, SOUTH = 2, WEST = 3 };
+    static const int kDirX[4];
+    static const int kDirY[4];
+    static Direction opposite(int dir) { return static_cast<Direction>(dir ^ 2); }
+
+    MazeGrid();
+    MazeGrid(int width, int height);
+    MazeGrid(const MazeGrid& other);
+    MazeGrid(MazeGrid&& other) noexcept;
+    MazeGrid& operator=(const MazeGrid& other);
+    MazeGrid& operator=(MazeGrid&& other) noexcept;
+
+    // Reallocate for width x height cells; every slot becomes a wall.
+    void resize(int width, int height);
+    void fill(bool wall);
+    // Use external words in this layout (padding bits set) without copying.
+    // They must outlive the grid; resize() switches back to owned storage.
+    void attach(Word* bits, int width, int height);
+    bool isView() const { return bits != nullptr && words.empty(); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getSlotWidth() const { return 2 * width + 1; }
+    int getSlotHeight() const { return 2 * height + 1; }
+    size_t getCellCount() const { return static_cast<size_t>(width) * height; }
+    bool empty() const { return bits == nullptr; }
+
+    // Slot access
+    bool isWall(int x, int y) const {
+        return (row(y)[x / kWordBits] >> (x % kWordBits)) & 1;
+    }
+    bool isOpen(int x, int y) const { return !isWall(x, y); }
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < getSlotWidth() && y >= 0 && y < getSlotHeight();
+    }
+    void setWall(int x, int y) {
+        row(y)[x / kWordBits] |= Word(1) << (x % kWordBits);
+    }
+    void carve(int x, int y) {
+        row(y)[x / kWordBits] &= ~(Word(1) << (x % kWordBits));
+    }
+
+    // Cell access (cx in [0, width), cy in [0, height))
+    bool isCellVisited(int cx, int cy) const { return isOpen(2 * cx + 1, 2 * cy + 1); }
+    bool hasNeighbor(int cx, int cy, int dir) const {
+        int nx = cx + kDirX[dir];
+        int ny = cy + kDirY[dir];
+        return nx >= 0 && nx < width && ny >= 0 && ny < height;
+    }
+    // True if the wall between the cell and its neighbour in dir is open.
+    bool canMove(int cx, int cy, int dir) const {
+        return isOpen(2 * cx + 1 + kDirX[dir], 2 * cy + 1 + kDirY[dir]);
+    }
+    // Open the wall towards dir and the neighbouring cell itself.
+    void carvePassage(int cx, int cy, int dir) {
+        carve(2 * cx + 1 + kDirX[dir], 2 * cy + 1 + kDirY[dir]);
+        carve(2 * (cx + kDirX[dir]) + 1, 2 * (cy + kDirY[dir]) + 1);
+    }
+    size_t cellIndex(int cx, int cy) const { return static_cast<size_t>(cy) * width + cx; }
+
+    // Raw row access
+    size_t getWordsPerRow() const { return wordsPerRow; }
+    const Word* row(int y) const { return bits + static_cast<size_t>(y) * wordsPerRow; }
+    Word* row(int y) { return bits + static_cast<size_t>(y) * wordsPerRow; }
+    size_t getWordCount() const { return bits ? wordsPerRow * getSlotHeight() : 0; }
+    size_t getByteSize() const { return getWordCount() * sizeof(Word); }
+
+private:
+    int width;
+    int height;
+    size_t wordsPerRow;
+    std::vector<Word> words;
+    Word* bits;  // words.data(), or the viewed memory
+};
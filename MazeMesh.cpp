@@ -0,0 +1,267 @@
+#include "MazeMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+void MazeMesh::clear() {
+    vertices.clear();
+    normals.clear();
+    indices.clear();
+}
+
+namespace {
+
+typedef MazeGrid::Word Word;
+
+bool testBit(const Word* bits, int x) {
+    return (bits[x / MazeGrid::kWordBits] >> (x % MazeGrid::kWordBits)) & 1;
+}
+
+// Call run(begin, end) for every maximal run of set bits in [first, last)
+template <typename Run>
+void forEachRun(const Word* bits, int first, int last, Run run) {
+    int x = first;
+    while (x < last) {
+        if (bits[x / MazeGrid::kWordBits] == 0) {
+            x = (x / MazeGrid::kWordBits + 1) * MazeGrid::kWordBits;
+            continue;
+        }
+        if (!testBit(bits, x)) {
+            x++;
+            continue;
+        }
+        int begin = x;
+        while (x < last && testBit(bits, x)) x++;
+        run(begin, x);
+    }
+}
+
+struct RingTable {
+    float cosines[MazeMesh::kTubeSides];
+    float sines[MazeMesh::kTubeSides];
+
+    RingTable() {
+        for (int s = 0; s < MazeMesh::kTubeSides; s++) {
+            double angle = 2 * 3.14159265358979323846 * s / MazeMesh::kTubeSides;
+            cosines[s] = static_cast<float>(std::cos(angle));
+            sines[s] = static_cast<float>(std::sin(angle));
+        }
+    }
+};
+
+}  // namespace
+
+void MazeMesh::buildWalls(const MazeGrid& maze, float cellSize, float wallHeight) {
+    buildWalls(maze, cellSize, wallHeight, 0, 0, maze.getSlotWidth(), maze.getSlotHeight());
+}
+
+void MazeMesh::buildWalls(const MazeGrid& maze, float cellSize, float wallHeight,
+                          int left, int top, int right, int bottom) {
+    clear();
+    // Small inset so coplanar faces of neighbouring walls do not z-fight
+    const float eps = 0.01f;
+    const float h = wallHeight;
+    int slotWidth = maze.getSlotWidth();
+    int slotHeight = maze.getSlotHeight();
+    size_t wordsPerRow = maze.getWordsPerRow();
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, slotWidth);
+    bottom = std::min(bottom, slotHeight);
+    if (left >= right || top >= bottom) return;
+
+    // Greedy meshing: every exposed side is merged along its row or column
+    // and the tops are merged into rectangles, so the mesh grows with the
+    // number of wall segments instead of the number of wall slots.
+    // Neighbours outside the region are still tested, so adjacent chunks
+    // do not get faces where their walls touch.
+    exposed.resize(wordsPerRow);
+    for (int y = top; y < bottom; y++) {
+        const Word* walls = maze.row(y);
+        float y0 = y * cellSize + eps;
+        float y1 = (y + 1) * cellSize - eps;
+
+        // North faces: walls with no wall above
+        for (size_t w = 0; w < wordsPerRow; w++) {
+            exposed[w] = walls[w] & (y > 0 ? ~maze.row(y - 1)[w] : ~Word(0));
+        }
+        forEachRun(exposed.data(), left, right, [&](int begin, int end) {
+            float x0 = begin * cellSize + eps;
+            float x1 = end * cellSize - eps;
+            addFace({x0, y0, 0}, {x1, y0, 0}, {x1, y0, h}, {x0, y0, h});
+        });
+
+        // South faces: walls with no wall below
+        for (size_t w = 0; w < wordsPerRow; w++) {
+            exposed[w] = walls[w] & (y < slotHeight - 1 ? ~maze.row(y + 1)[w] : ~Word(0));
+        }
+        forEachRun(exposed.data(), left, right, [&](int begin, int end) {
+            float x0 = begin * cellSize + eps;
+            float x1 = end * cellSize - eps;
+            addFace({x1, y1, 0}, {x0, y1, 0}, {x0, y1, h}, {x1, y1, h});
+        });
+    }
+
+    // East and west faces run down the columns
+    for (int x = left; x < right; x++) {
+        float x0 = x * cellSize + eps;
+        float x1 = (x + 1) * cellSize - eps;
+        for (int side = 0; side < 2; side++) {
+            int neighbor = side == 0 ? x + 1 : x - 1;
+            bool edge = neighbor < 0 || neighbor >= slotWidth;
+            int y = top;
+            while (y < bottom) {
+                auto isExposed = [&](int row) {
+                    const Word* walls = maze.row(row);
+                    return testBit(walls, x) && (edge || !testBit(walls, neighbor));
+                };
+                if (!isExposed(y)) {
+                    y++;
+                    continue;
+                }
+                int begin = y;
+                while (y < bottom && isExposed(y)) y++;
+                float y0 = begin * cellSize + eps;
+                float y1 = y * cellSize - eps;
+                if (side == 0) {
+                    addFace({x1, y0, 0}, {x1, y1, 0}, {x1, y1, h}, {x1, y0, h});
+                } else {
+                    addFace({x0, y1, 0}, {x0, y0, 0}, {x0, y0, h}, {x0, y1, h});
+                }
+            }
+        }
+    }
+
+    // Tops: grow each row run downwards while the rows below are walls
+    // over the same span, clearing the covered slots from a scratch mask
+    remaining.assign(maze.row(top), maze.row(top) + wordsPerRow * (bottom - top));
+    auto maskRow = [&](int y) {
+        return remaining.data() + static_cast<size_t>(y - top) * wordsPerRow;
+    };
+    for (int y = top; y < bottom; y++) {
+        forEachRun(maskRow(y), left, right, [&](int begin, int end) {
+            auto covers = [&](int row) {
+                for (int x = begin; x < end; x++) {
+                    if (!testBit(maskRow(row), x)) return false;
+                }
+                return true;
+            };
+            int last = y + 1;
+            while (last < bottom && covers(last)) last++;
+            for (int row = y + 1; row < last; row++) {
+                Word* bits = maskRow(row);
+                for (int x = begin; x < end; x++) {
+                    bits[x / MazeGrid::kWordBits] &= ~(Word(1) << (x % MazeGrid::kWordBits));
+                }
+            }
+            // Inset once more to stay off the sides
+            float x0 = begin * cellSize + 2 * eps;
+            float x1 = end * cellSize - 2 * eps;
+            float y0 = y * cellSize + 2 * eps;
+            float y1 = last * cellSize - 2 * eps;
+            addFace({x0, y0, h}, {x1, y0, h}, {x1, y1, h}, {x0, y1, h});
+        });
+    }
+}
+
+void MazeMesh::buildTube(const std::vector<std::pair<int, int>>& path, float cellSize,
+                         float radius, float height) {
+    clear();
+    if (path.size() < 2) return;
+
+    // Ring directions, computed once for every tube
+    static const RingTable ring;
+
+    size_t count = path.size();
+    vertices.reserve(count * kTubeSides * 3);
+    normals.reserve(count * kTubeSides * 3);
+    for (size_t i = 0; i < count; i++) {
+        // Direction along the path: the bisector at corners, where the ring
+        // is widened sideways so the tube keeps its thickness
+        size_t prev = i > 0 ? i - 1 : i;
+        size_t next = i + 1 < count ? i + 1 : i;
+        float dx = static_cast<float>(path[next].first - path[prev].first);
+        float dy = static_cast<float>(path[next].second - path[prev].second);
+        if (i > 0 && i + 1 < count) {
+            float ax = static_cast<float>(path[i].first - path[prev].first);
+            float ay = static_cast<float>(path[i].second - path[prev].second);
+            float bx = static_cast<float>(path[next].first - path[i].first);
+            float by = static_cast<float>(path[next].second - path[i].second);
+            float la = std::sqrt(ax * ax + ay * ay);
+            float lb = std::sqrt(bx * bx + by * by);
+            if (la > 0 && lb > 0) {
+                dx = ax / la + bx / lb;
+                dy = ay / la + by / lb;
+            }
+        }
+        float length = std::sqrt(dx * dx + dy * dy);
+        float miter = 1.0f;
+        if (length > 0) {
+            if (i > 0 && i + 1 < count) miter = std::min(2.0f / length, 2.0f);
+            dx /= length;
+            dy /= length;
+        }
+        // right = direction x up
+        float rightX = dy;
+        float rightY = -dx;
+
+        float cx = (path[i].first + 0.5f) * cellSize;
+        float cy = (path[i].second + 0.5f) * cellSize;
+        for (int s = 0; s < kTubeSides; s++) {
+            float nx = rightX * ring.cosines[s];
+            float ny = rightY * ring.cosines[s];
+            float nz = ring.sines[s];
+            vertices.push_back(cx + nx * radius * miter);
+            vertices.push_back(cy + ny * radius * miter);
+            vertices.push_back(height + nz * radius);
+            normals.push_back(nx);
+            normals.push_back(ny);
+            normals.push_back(nz);
+        }
+    }
+
+    indices.reserve(getTubeIndexCount(count));
+    for (size_t i = 0; i + 1 < count; i++) {
+        uint32_t first = static_cast<uint32_t>(i * kTubeSides);
+        uint32_t second = first + kTubeSides;
+        for (uint32_t s = 0; s < kTubeSides; s++) {
+            uint32_t t = (s + 1) % kTubeSides;
+            const uint32_t quad[6] = {first + s, second + s, first + t,
+                                      first + t, second + s, second + t};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void MazeMesh::addFace(const Vec3& bl, const Vec3& br, const Vec3& tr, const Vec3& tl) {
+    uint32_t index = static_cast<uint32_t>(getNumVertices());
+    for (const Vec3* v : {&bl, &br, &tr, &tl}) {
+        vertices.push_back(v->x);
+        vertices.push_back(v->y);
+        vertices.push_back(v->z);
+    }
+
+    // (br - bl) x (tr - bl), normalised
+    float ax = br.x - bl.x, ay = br.y - bl.y, az = br.z - bl.z;
+    float bx = tr.x - bl.x, by = tr.y - bl.y, bz = tr.z - bl.z;
+    float nx = ay * bz - az * by;
+    float ny = az * bx - ax * bz;
+    float nz = ax * by - ay * bx;
+    float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (length > 0) {
+        nx /= length;
+        ny /= length;
+        nz /= length;
+    }
+    for (int i = 0; i < 4; i++) {
+        normals.push_back(nx);
+        normals.push_back(ny);
+        normals.push_back(nz);
+    }
+
+    const uint32_t quad[6] = {0, 1, 2, 0, 2, 3};
+    for (uint32_t corner : quad) {
+        indices.push_back(index + corner);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+
+// CPU-side geometry for the 3D view (walls and the solution tube), kept free
+// of openFrameworks so it can be built once per maze and uploaded to a VBO
+// as plain arrays.
+//
+// Slot (x, y) covers [x, x + 1) * cellSize on the floor plane, walls rise
+// along +z. Faces shared by two adjacent walls are skipped, and collinear
+// faces and tops are merged greedily into long quads.
+class MazeMesh {
+public:
+    std::vector<float> vertices;   // x, y, z per vertex
+    std::vector<float> normals;    // x, y, z per vertex
+    std::vector<uint32_t> indices; // triangles
+
+    void clear();
+    size_t getNumVertices() const { return vertices.size() / 3; }
+    size_t getNumIndices() const { return indices.size(); }
+    size_t getByteSize() const {
+        return (vertices.size() + normals.size()) * sizeof(float) +
+               indices.size() * sizeof(uint32_t);
+    }
+
+    // Replace the contents with every wall of the maze
+    void buildWalls(const MazeGrid& maze, float cellSize, float wallHeight);
+    // Only the walls in slots [left, right) x [top, bottom), for chunked meshes
+    void buildWalls(const MazeGrid& maze, float cellSize, float wallHeight,
+                    int left, int top, int right, int bottom);
+
+    // Tube through the slot centres of a path, lifted to height. Each path
+    // point has one shared ring of kTubeSides vertices, so the first n
+    // points are drawn by the first getTubeIndexCount(n) indices. The tube
+    // is one colour, set when drawing rather than stored per vertex.
+    static const int kTubeSides = 8;
+    void buildTube(const std::vector<std::pair<int, int>>& path, float cellSize, float radius,
+                   float height);
+    static size_t getTubeIndexCount(size_t points) {
+        return points > 1 ? (points - 1) * kTubeSides * 6 : 0;
+    }
+
+private:
+    struct Vec3 {
+        float x, y, z;
+    };
+    // Wall meshing scratch, kept so building chunk after chunk reuses it
+    std::vector<MazeGrid::Word> exposed;
+    std::vector<MazeGrid::Word> remaining;
+
+    // Quad bl, br, tr, tl as two triangles with a flat normal
+    void addFace(const Vec3& bl, const Vec3& br, const Vec3& tr, const Vec3& tl);
+};
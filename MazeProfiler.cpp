@@ -0,0 +1,178 @@
+#include "MazeProfiler.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+// Small sequential ids read better in trace viewers than native thread ids
+unsigned traceThreadId() {
+    static std::atomic<unsigned> nextId(1);
+    thread_local unsigned id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+double toMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+}  // namespace
+
+MazeProfiler& MazeProfiler::get() {
+    static MazeProfiler profiler;
+    return profiler;
+}
+
+const char* MazeProfiler::getCounterName(Counter counter) {
+    switch (counter) {
+        case RNG_DRAWS: return "RNG draws";
+        case WALK_REJECTS: return "Rejected walk moves";
+        case CELLS_CARVED: return "Cells carved";
+        case NODES_EXPANDED: return "Nodes expanded";
+        case PEAK_QUEUE: return "Peak queue";
+        case VERTICES_BUILT: return "Vertices built";
+        case INDICES_BUILT: return "Indices built";
+        case DRAW_CALLS: return "Draw calls";
+        case COUNTER_COUNT: break;
+    }
+    return "";
+}
+
+int MazeProfiler::getPhaseId(const char* name) {
+    std::lock_guard<std::mutex> guard(phaseLock);
+    int count = phaseCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (std::strcmp(phases[i].name, name) == 0) return i;
+    }
+    // Past the limit further phases share the last slot
+    if (count == kMaxPhases) return kMaxPhases - 1;
+    phases[count].name = name;
+    phaseCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void MazeProfiler::record(int phase, Clock::time_point start, Clock::time_point end) {
+    uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    Phase& stats = phases[phase];
+    stats.calls.fetch_add(1, std::memory_order_relaxed);
+    stats.lastNs.store(ns, std::memory_order_relaxed);
+    stats.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t longest = stats.maxNs.load(std::memory_order_relaxed);
+    while (ns > longest &&
+           !stats.maxNs.compare_exchange_weak(longest, ns, std::memory_order_relaxed)) {}
+
+    if (!isTracing()) return;
+    std::lock_guard<std::mutex> guard(traceLock);
+    // Scopes that began before startTrace() are clipped to it
+    if (!tracing.load(std::memory_order_relaxed) || end < traceStart) return;
+    if (traceEvents.size() >= kMaxTraceEvents) {
+        droppedEvents++;
+        return;
+    }
+    using std::chrono::microseconds;
+    int64_t startUs =
+        std::chrono::duration_cast<microseconds>(std::max(start, traceStart) - traceStart).count();
+    int64_t endUs = std::chrono::duration_cast<microseconds>(end - traceStart).count();
+    traceEvents.push_back({phase, traceThreadId(), startUs, endUs - startUs});
+}
+
+std::vector<MazeProfiler::PhaseStats> MazeProfiler::getPhases() const {
+    int count = phaseCount.load(std::memory_order_acquire);
+    std::vector<PhaseStats> result;
+    result.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const Phase& stats = phases[i];
+        result.push_back({stats.name, stats.calls.load(std::memory_order_relaxed),
+                          toMs(stats.lastNs.load(std::memory_order_relaxed)),
+                          toMs(stats.maxNs.load(std::memory_order_relaxed)),
+                          toMs(stats.totalNs.load(std::memory_order_relaxed))});
+    }
+    return result;
+}
+
+void MazeProfiler::reset() {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    int count = phaseCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        phases[i].calls.store(0, std::memory_order_relaxed);
+        phases[i].lastNs.store(0, std::memory_order_relaxed);
+        phases[i].maxNs.store(0, std::memory_order_relaxed);
+        phases[i].totalNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+//--------------------------------------------------------------
+void MazeProfiler::startTrace() {
+    std::lock_guard<std::mutex> guard(traceLock);
+    traceEvents.clear();
+    counterSamples.clear();
+    droppedEvents = 0;
+    traceStart = Clock::now();
+    tracing.store(true, std::memory_order_relaxed);
+}
+
+void MazeProfiler::sampleCounters() {
+    if (!isTracing()) return;
+    CounterSample sample;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        sample.values[i] = getCounter(static_cast<Counter>(i));
+    }
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (!tracing.load(std::memory_order_relaxed)) return;
+    if (counterSamples.size() >= kMaxTraceEvents) {
+        droppedEvents++;
+        return;
+    }
+    sample.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - traceStart).count();
+    counterSamples.push_back(sample);
+}
+
+bool MazeProfiler::stopTrace(const std::string& path) {
+    std::vector<TraceEvent> events;
+    std::vector<CounterSample> samples;
+    size_t dropped;
+    {
+        std::lock_guard<std::mutex> guard(traceLock);
+        tracing.store(false, std::memory_order_relaxed);
+        events.swap(traceEvents);
+        samples.swap(counterSamples);
+        dropped = droppedEvents;
+    }
+    // Final counter values close the trace
+    CounterSample last;
+    last.timeUs = 0;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        last.values[i] = getCounter(static_cast<Counter>(i));
+    }
+
+    // Phase names are literals from the call sites and need no escaping
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        last.timeUs = std::max(last.timeUs, event.startUs + event.durationUs);
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << phases[event.phase].name
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.startUs
+            << ",\"dur\":" << event.durationUs << "}";
+    }
+    // Counter samples as counter events, one track per counter
+    if (!samples.empty()) last.timeUs = std::max(last.timeUs, samples.back().timeUs);
+    samples.push_back(last);
+    for (size_t i = 0; i < samples.size(); i++) {
+        out << (events.empty() && i == 0 ? "\n" : ",\n")
+            << "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":"
+            << samples[i].timeUs << ",\"args\":{";
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            out << (c ? "," : "") << "\"" << getCounterName(static_cast<Counter>(c)) << "\":"
+                << samples[i].values[c];
+        }
+        out << "}}";
+    }
+    out << "\n],\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+    return static_cast<bool>(out);
+}
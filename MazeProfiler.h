@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Built in unless MAZE_PROFILE is defined to 0, which compiles the macros
+// below to nothing
+#ifndef MAZE_PROFILE
+#define MAZE_PROFILE 1
+#endif
+
+// Process-wide counters and phase timers for the hot paths, cheap enough to
+// leave on in release builds.
+//
+// Counters are relaxed atomics. Phases are named once per call site and
+// timed by MazeProfileScope; each keeps its last, longest and total time.
+// While a trace is recording, every timed scope is also kept as an event
+// and stopTrace() writes them as Chrome trace JSON (chrome://tracing or
+// ui.perfetto.dev), one row per thread.
+class MazeProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Counter {
+        RNG_DRAWS,       // last generated maze: random numbers drawn
+        WALK_REJECTS,    // last generated maze: random-walk moves that carved nothing
+        CELLS_CARVED,    // last generated maze
+        NODES_EXPANDED,  // last search: cells taken off the frontier
+        PEAK_QUEUE,      // last search: largest frontier
+        VERTICES_BUILT,  // total geometry built by the renderer
+        INDICES_BUILT,
+        DRAW_CALLS,      // last frame
+        COUNTER_COUNT
+    };
+
+    struct PhaseStats {
+        const char* name;
+        uint64_t calls;
+        double lastMs;
+        double maxMs;
+        double totalMs;
+    };
+
+    static MazeProfiler& get();
+
+    void set(Counter counter, uint64_t value) {
+        counters[counter].store(value, std::memory_order_relaxed);
+    }
+    void add(Counter counter, uint64_t value) {
+        counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+    uint64_t getCounter(Counter counter) const {
+        return counters[counter].load(std::memory_order_relaxed);
+    }
+    static const char* getCounterName(Counter counter);
+
+    // Id of the phase called name, registered on first use. name must
+    // outlive the profiler (a string literal).
+    int getPhaseId(const char* name);
+    void record(int phase, Clock::time_point start, Clock::time_point end);
+    // Registered phases, in registration order
+    std::vector<PhaseStats> getPhases() const;
+    // Zero the counters and phase statistics
+    void reset();
+
+    // Record timed scopes until stopTrace(), which writes them to path and
+    // returns false on I/O errors. Events past kMaxTraceEvents are dropped.
+    void startTrace();
+    bool stopTrace(const std::string& path);
+    bool isTracing() const { return tracing.load(std::memory_order_relaxed); }
+    // While tracing, keep the counters' current values as one sample (e.g.
+    // once per frame, before per-frame counters restart)
+    void sampleCounters();
+
+private:
+    static const int kMaxPhases = 64;
+    static const size_t kMaxTraceEvents = size_t(1) << 20;
+
+    struct Phase {
+        const char* name = nullptr;
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> lastNs{0};
+        std::atomic<uint64_t> maxNs{0};
+        std::atomic<uint64_t> totalNs{0};
+    };
+    struct TraceEvent {
+        int phase;
+        unsigned thread;
+        int64_t startUs;
+        int64_t durationUs;
+    };
+    struct CounterSample {
+        int64_t timeUs;
+        uint64_t values[COUNTER_COUNT];
+    };
+
+    MazeProfiler() = default;
+
+    std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+    Phase phases[kMaxPhases];
+    std::atomic<int> phaseCount{0};
+    std::mutex phaseLock;
+
+    std::atomic<bool> tracing{false};
+    std::mutex traceLock;
+    Clock::time_point traceStart;
+    std::vector<TraceEvent> traceEvents;
+    std::vector<CounterSample> counterSamples;
+    size_t droppedEvents = 0;
+};
+
+// Times its own lifetime as one call of a phase
+class MazeProfileScope {
+public:
+    explicit MazeProfileScope(int phase) : phase(phase), start(MazeProfiler::Clock::now()) {}
+    ~MazeProfileScope() { MazeProfiler::get().record(phase, start, MazeProfiler::Clock::now()); }
+    MazeProfileScope(const MazeProfileScope&) = delete;
+    MazeProfileScope& operator=(const MazeProfileScope&) = delete;
+
+private:
+    int phase;
+    MazeProfiler::Clock::time_point start;
+};
+
+#define MAZE_PROFILE_JOIN2(a, b) a##b
+#define MAZE_PROFILE_JOIN(a, b) MAZE_PROFILE_JOIN2(a, b)
+
+#if MAZE_PROFILE
+// Time the rest of the enclosing block as phase name
+#define MAZE_PROFILE_SCOPE(name)                                                             \
+    static const int MAZE_PROFILE_JOIN(mazePhase, __LINE__) =                                \
+        MazeProfiler::get().getPhaseId(name);                                                \
+    MazeProfileScope MAZE_PROFILE_JOIN(mazeScope, __LINE__)(MAZE_PROFILE_JOIN(mazePhase, __LINE__))
+#define MAZE_PROFILE_SET(counter, value) MazeProfiler::get().set(MazeProfiler::counter, value)
+#define MAZE_PROFILE_ADD(counter, value) MazeProfiler::get().add(MazeProfiler::counter, value)
+#else
+#define MAZE_PROFILE_SCOPE(name) ((void)0)
+#define MAZE_PROFILE_SET(counter, value) ((void)0)
+#define MAZE_PROFILE_ADD(counter, value) ((void)0)
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Small, fast, seedable PRNG (xoshiro256**) for maze generation.
+//
+// Every generator owns its own engine, so there is no shared state between
+// threads, and the sequence depends only on the 64-bit seed: the same seed
+// produces the same maze on every platform and standard library.
+class MazeRandom {
+public:
+    explicit MazeRandom(uint64_t seed = 0) { setSeed(seed); }
+
+    // Expand the seed with SplitMix64 so that nearby seeds diverge quickly
+    void setSeed(uint64_t seed) {
+        this->seed = seed;
+        for (int i = 0; i < 4; i++) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+    uint64_t getSeed() const { return seed; }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, n) without floating point or modulo bias
+    // (Lemire's multiply-and-reject). n must be in [1, 2^32).
+    uint32_t nextBounded(uint32_t n) {
+        uint64_t m = (next() >> 32) * n;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < n) {
+            uint32_t threshold = static_cast<uint32_t>(-n) % n;
+            while (low < threshold) {
+                m = (next() >> 32) * n;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // Fresh non-deterministic seed for callers that do not supply one
+    static uint64_t randomSeed() {
+        std::random_device device;
+        uint64_t entropy = (static_cast<uint64_t>(device()) << 32) ^ device();
+        return entropy ^ static_cast<uint64_t>(
+            std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    }
+
+private:
+    uint64_t seed;
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
@@ -0,0 +1,257 @@
+#include "MazeRaster.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "MazeProfiler.h"
+
+#ifdef MAZE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+struct MazeRaster::Band {
+    std::vector<uint8_t> pixels;
+#ifdef MAZE_HAVE_ZLIB
+    z_stream stream;
+    bool streamReady = false;
+    std::vector<uint8_t> packed;
+    uLong adler = 0;
+
+    ~Band() {
+        if (streamReady) deflateEnd(&stream);
+    }
+#endif
+};
+
+namespace {
+
+enum { FLOOR = 0, WALL = 1, PATH = 2 };
+
+#ifdef MAZE_HAVE_ZLIB
+void putBigEndian(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+void writeChunk(std::ostream& out, const char* type, const uint8_t* data, size_t size) {
+    uint8_t word[4];
+    putBigEndian(word, static_cast<uint32_t>(size));
+    out.write(reinterpret_cast<const char*>(word), 4);
+    out.write(type, 4);
+    out.write(reinterpret_cast<const char*>(data), size);
+    uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+    if (size > 0) crc = crc32(crc, data, static_cast<uInt>(size));
+    putBigEndian(word, static_cast<uint32_t>(crc));
+    out.write(reinterpret_cast<const char*>(word), 4);
+}
+#endif
+
+}  // namespace
+
+MazeRaster::MazeRaster(MazeThreadPool& pool)
+    : pool(pool), slotPixels(4), colors{{33, 33, 33}, {100, 100, 120}, {255, 240, 240}},
+      compressionLevel(1) {}
+
+MazeRaster::~MazeRaster() = default;
+
+void MazeRaster::setSlotPixels(int pixels) {
+    if (pixels < 1) throw std::invalid_argument("Slot size must be at least one pixel");
+    slotPixels = pixels;
+}
+
+void MazeRaster::setColors(Color wall, Color floor, Color path) {
+    colors[FLOOR] = floor;
+    colors[WALL] = wall;
+    colors[PATH] = path;
+}
+
+bool MazeRaster::isPngSupported() {
+#ifdef MAZE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool MazeRaster::write(const std::string& path, Format format, const MazeGrid& maze,
+                       const std::vector<std::pair<int, int>>& solution) {
+    if (format == Format::PNG && !isPngSupported()) return false;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    return write(out, format, maze, solution);
+}
+
+bool MazeRaster::write(std::ostream& out, Format format, const MazeGrid& maze,
+                       const std::vector<std::pair<int, int>>& solution) {
+    MAZE_PROFILE_SCOPE("raster");
+    bool png = format == Format::PNG;
+    if (png && !isPngSupported()) return false;
+    size_t width = getImageWidth(maze);
+    size_t height = getImageHeight(maze);
+    if (png && (width > 0x7FFFFFFF || height > 0x7FFFFFFF)) {
+        throw std::invalid_argument("Image too large for PNG");
+    }
+
+    bool hasPath = !solution.empty();
+    if (hasPath) {
+        pathMask.resize(maze.getWidth(), maze.getHeight());
+        pathMask.fill(false);
+        for (const auto& slot : solution) {
+            pathMask.setWall(slot.first, slot.second);
+        }
+    }
+
+    // PNG pixels are palette indices, PGM pixels grey levels
+    uint8_t values[3] = {FLOOR, WALL, PATH};
+    if (!png) {
+        for (int i = 0; i < 3; i++) {
+            values[i] = static_cast<uint8_t>((299 * colors[i].r + 587 * colors[i].g +
+                                              114 * colors[i].b + 500) / 1000);
+        }
+    }
+
+#ifdef MAZE_HAVE_ZLIB
+    uLong adler = adler32(0, nullptr, 0);
+    if (png) {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+        uint8_t header[13] = {};
+        putBigEndian(header, static_cast<uint32_t>(width));
+        putBigEndian(header + 4, static_cast<uint32_t>(height));
+        header[8] = 8;  // bit depth
+        header[9] = 3;  // palette colour
+        writeChunk(out, "IHDR", header, sizeof(header));
+        uint8_t palette[9];
+        for (int i = 0; i < 3; i++) {
+            palette[3 * i] = colors[i].r;
+            palette[3 * i + 1] = colors[i].g;
+            palette[3 * i + 2] = colors[i].b;
+        }
+        writeChunk(out, "PLTE", palette, sizeof(palette));
+        // zlib stream header: deflate, 32 KB window
+        static const uint8_t zlibHeader[2] = {0x78, 0x9C};
+        writeChunk(out, "IDAT", zlibHeader, sizeof(zlibHeader));
+    } else
+#endif
+    {
+        out << "P5\n" << width << " " << height << "\n255\n";
+    }
+
+    // Band height in slot rows, and how many bands are in memory at once
+    size_t rowBytes = width + (png ? 1 : 0);
+    int slotHeight = maze.getSlotHeight();
+    int bandSlots = static_cast<int>(std::min<size_t>(
+        slotHeight, std::max<size_t>(1, kBandBytes / (rowBytes * slotPixels))));
+    int bandCount = (slotHeight + bandSlots - 1) / bandSlots;
+    int window = std::min<int>(bandCount, pool.getThreadCount());
+    while (static_cast<int>(bands.size()) < window) {
+        bands.push_back(std::make_unique<Band>());
+    }
+
+    for (int first = 0; first < bandCount; first += window) {
+        int count = std::min(window, bandCount - first);
+        std::atomic<bool> failed(false);
+        pool.parallelFor(count, [&](size_t i, unsigned) {
+            int index = first + static_cast<int>(i);
+            int y0 = index * bandSlots;
+            rasterize(maze, hasPath, values, y0, std::min(y0 + bandSlots, slotHeight), png, *bands[i]);
+            if (png && !deflateBand(*bands[i], index == bandCount - 1)) failed = true;
+        });
+        if (failed) return false;
+
+        for (int i = 0; i < count; i++) {
+            const Band& band = *bands[i];
+#ifdef MAZE_HAVE_ZLIB
+            if (png) {
+                writeChunk(out, "IDAT", band.packed.data(), band.packed.size());
+                adler = adler32_combine(adler, band.adler, static_cast<z_off_t>(band.pixels.size()));
+                continue;
+            }
+#endif
+            out.write(reinterpret_cast<const char*>(band.pixels.data()), band.pixels.size());
+        }
+        if (!out) return false;
+    }
+
+#ifdef MAZE_HAVE_ZLIB
+    if (png) {
+        uint8_t trailer[4];
+        putBigEndian(trailer, static_cast<uint32_t>(adler));
+        writeChunk(out, "IDAT", trailer, sizeof(trailer));
+        writeChunk(out, "IEND", nullptr, 0);
+    }
+#endif
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+//--------------------------------------------------------------
+void MazeRaster::rasterize(const MazeGrid& maze, bool hasPath, const uint8_t values[3], int y0,
+                           int y1, bool filtered, Band& band) const {
+    size_t width = getImageWidth(maze);
+    size_t rowBytes = width + (filtered ? 1 : 0);
+    band.pixels.resize(static_cast<size_t>(y1 - y0) * slotPixels * rowBytes);
+
+    int slotWidth = maze.getSlotWidth();
+    uint8_t* out = band.pixels.data();
+    for (int y = y0; y < y1; y++) {
+        uint8_t* pixel = out;
+        if (filtered) *pixel++ = 0;  // PNG filter type None
+        const MazeGrid::Word* walls = maze.row(y);
+        const MazeGrid::Word* path = hasPath ? pathMask.row(y) : nullptr;
+        for (int x = 0; x < slotWidth; x++) {
+            size_t word = x / MazeGrid::kWordBits;
+            MazeGrid::Word bit = MazeGrid::Word(1) << (x % MazeGrid::kWordBits);
+            uint8_t value = (walls[word] & bit) ? values[WALL]
+                            : (path && (path[word] & bit)) ? values[PATH]
+                                                           : values[FLOOR];
+            if (slotPixels == 1) {
+                pixel[x] = value;
+            } else {
+                std::memset(pixel + static_cast<size_t>(x) * slotPixels, value, slotPixels);
+            }
+        }
+        // The slot's remaining pixel rows are copies of the first
+        for (int i = 1; i < slotPixels; i++) {
+            std::memcpy(out + i * rowBytes, out, rowBytes);
+        }
+        out += slotPixels * rowBytes;
+    }
+}
+
+bool MazeRaster::deflateBand(Band& band, bool last) const {
+#ifdef MAZE_HAVE_ZLIB
+    // Raw deflate, so the bands' segments concatenate into one zlib stream;
+    // each ends on a byte boundary (sync flush) except the final one
+    z_stream& stream = band.stream;
+    if (!band.streamReady) {
+        std::memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        band.streamReady = true;
+    } else if (deflateReset(&stream) != Z_OK ||
+               deflateParams(&stream, compressionLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    band.adler = adler32(adler32(0, nullptr, 0), band.pixels.data(), static_cast<uInt>(band.pixels.size()));
+    // Room for the worst case plus the empty block a sync flush appends
+    band.packed.resize(deflateBound(&stream, band.pixels.size()) + 16);
+    stream.next_in = band.pixels.data();
+    stream.avail_in = static_cast<uInt>(band.pixels.size());
+    stream.next_out = band.packed.data();
+    stream.avail_out = static_cast<uInt>(band.packed.size());
+    int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (result != (last ? Z_STREAM_END : Z_OK) || stream.avail_in != 0) return false;
+    band.packed.resize(band.packed.size() - stream.avail_out);
+    return true;
+#else
+    (void)band;
+    (void)last;
+    return false;
+#endif
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
+#include "MazeThreadPool.h"
+
+// CPU rasteriser writing a maze straight to a PGM or PNG image, with no GL
+// context or window.
+//
+// Every slot becomes a square of slotPixels x slotPixels pixels: wall, floor
+// or, for slots on the given solution, path colour. The image is produced in
+// horizontal bands of slot rows that are rasterised (and, for PNG, deflated)
+// in parallel on the pool, a window of bands at a time, and written out in
+// order, so memory stays bounded by the window whatever the maze size.
+//
+// PNGs are palette images. Each band is compressed as an independent
+// deflate segment and the segments are joined into one zlib stream, which
+// keeps compression off the serial path. PNG output needs zlib at build
+// time (see isPngSupported()).
+//
+// Band buffers are kept between calls; use one MazeRaster per thread.
+class MazeRaster {
+public:
+    enum class Format { PGM, PNG };
+
+    struct Color {
+        uint8_t r, g, b;
+    };
+
+    explicit MazeRaster(MazeThreadPool& pool = MazeThreadPool::shared());
+    ~MazeRaster();
+    MazeRaster(const MazeRaster&) = delete;
+    MazeRaster& operator=(const MazeRaster&) = delete;
+
+    // Side of one slot in pixels; throws std::invalid_argument if < 1
+    void setSlotPixels(int pixels);
+    int getSlotPixels() const { return slotPixels; }
+    // Defaults match the viewer's 2D mode. PGM uses their luma.
+    void setColors(Color wall, Color floor, Color path);
+    // zlib level 0-9 for PNG output; defaults to 1, as deflate dominates
+    // the time and flat maze rows compress well even at the fastest level
+    void setCompressionLevel(int level) { compressionLevel = level; }
+
+    static bool isPngSupported();
+    size_t getImageWidth(const MazeGrid& maze) const {
+        return static_cast<size_t>(maze.getSlotWidth()) * slotPixels;
+    }
+    size_t getImageHeight(const MazeGrid& maze) const {
+        return static_cast<size_t>(maze.getSlotHeight()) * slotPixels;
+    }
+
+    // Returns false on I/O errors, or for PNG without zlib. Throws
+    // std::invalid_argument if the image would be too large for the format.
+    bool write(std::ostream& out, Format format, const MazeGrid& maze,
+               const std::vector<std::pair<int, int>>& solution = {});
+    bool write(const std::string& path, Format format, const MazeGrid& maze,
+               const std::vector<std::pair<int, int>>& solution = {});
+
+private:
+    // Slot rows per band aim at about this many bytes of image
+    static const size_t kBandBytes = 1 << 20;
+
+    struct Band;
+
+    MazeThreadPool& pool;
+    int slotPixels;
+    Color colors[3];  // floor, wall, path
+    int compressionLevel;
+
+    // Solution slots as set bits in the maze's layout
+    MazeGrid pathMask;
+    std::vector<std::unique_ptr<Band>> bands;
+
+    // Paint slot rows [y0, y1) into band as image rows, with a leading PNG
+    // filter byte per row if filtered
+    void rasterize(const MazeGrid& maze, bool hasPath, const uint8_t values[3], int y0, int y1,
+                   bool filtered, Band& band) const;
+    bool deflateBand(Band& band, bool last) const;
+};
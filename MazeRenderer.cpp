@@ -0,0 +1,383 @@
+#include "MazeRenderer.h"
+#include "MazeProfiler.h"
+
+namespace {
+const ofColor kWallColor(100, 100, 120);
+const ofColor kSolutionCellColor(255, 240, 240);
+// Indexed by MazeSolver::CellState
+const ofColor kSearchColors[] = {ofColor(0, 0), ofColor(80, 200, 255), ofColor(40, 80, 150),
+                                 ofColor(90, 40, 45)};
+
+void paintTexel(unsigned char* texel, bool wall, uint8_t search) {
+    // Open slots stay transparent so the background shows through, unless
+    // the search has reached them
+    const ofColor& color = wall ? kWallColor : kSearchColors[search];
+    texel[0] = color.r;
+    texel[1] = color.g;
+    texel[2] = color.b;
+    texel[3] = wall || search ? 255 : 0;
+}
+
+// Conservative test: false only if all eight corners are outside one plane
+bool boxInFrustum(const glm::mat4& mvp, const glm::vec3& lo, const glm::vec3& hi) {
+    int outside[6] = {0, 0, 0, 0, 0, 0};
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec4 p = mvp * glm::vec4(corner & 1 ? hi.x : lo.x,
+                                      corner & 2 ? hi.y : lo.y,
+                                      corner & 4 ? hi.z : lo.z, 1.0f);
+        outside[0] += p.x < -p.w;
+        outside[1] += p.x > p.w;
+        outside[2] += p.y < -p.w;
+        outside[3] += p.y > p.w;
+        outside[4] += p.z < -p.w;
+        outside[5] += p.z > p.w;
+    }
+    for (int plane = 0; plane < 6; plane++) {
+        if (outside[plane] == 8) return false;
+    }
+    return true;
+}
+}
+
+MazeRenderer::MazeRenderer()
+    : chunksX(0), lodDistance(192), visibleChunks(0), flatChunks(0),
+      wallsDirty(true), builtCellSize(0), builtWallHeight(0),
+      textureDirty(true), solutionDirty(true), shadedCount(0), linesCellSize(0),
+      tubeDirty(true), tubeCellSize(0), pathLightRadius(0), pathLightsUploaded(false),
+      searchShown(false) {}
+
+void MazeRenderer::drawWalls3D(const MazeGrid& maze, float cellSize, float wallHeight) {
+    if (wallsDirty || cellSize != builtCellSize || wallHeight != builtWallHeight) {
+        uploadWalls(maze, cellSize, wallHeight);
+    } else {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (!chunkDirty[i]) continue;
+            uploadChunk(maze, *chunks[i], cellSize, wallHeight);
+            chunkDirty[i] = 0;
+        }
+    }
+
+    glm::mat4 modelView = ofGetCurrentMatrix(OF_MATRIX_MODELVIEW);
+    glm::mat4 mvp = ofGetCurrentMatrix(OF_MATRIX_PROJECTION) * modelView;
+    glm::vec3 eye = glm::vec3(glm::inverse(modelView) * glm::vec4(0, 0, 0, 1));
+    float flatRange = lodDistance * cellSize;
+
+    visibleChunks = 0;
+    flatList.clear();
+    for (const auto& chunk : chunks) {
+        glm::vec3 lo(chunk->left * cellSize, chunk->top * cellSize, 0);
+        glm::vec3 hi(chunk->right * cellSize, chunk->bottom * cellSize, wallHeight);
+        if (!boxInFrustum(mvp, lo, hi)) continue;
+        visibleChunks++;
+        if (lodDistance > 0 && glm::distance(eye, glm::clamp(eye, lo, hi)) > flatRange) {
+            flatList.push_back(chunk.get());
+        } else if (chunk->indexCount > 0) {
+            chunk->vbo.drawElements(GL_TRIANGLES, chunk->indexCount);
+            MAZE_PROFILE_ADD(DRAW_CALLS, 1);
+        }
+    }
+
+    // Far chunks: the matching part of the slot texture, just above the floor
+    flatChunks = static_cast<int>(flatList.size());
+    if (flatList.empty()) return;
+    prepareTexture(maze, false);
+    uploadTexture();
+    ofSetColor(255);
+    for (const WallChunk* chunk : flatList) {
+        int width = chunk->right - chunk->left;
+        int height = chunk->bottom - chunk->top;
+        slotTexture.drawSubsection(chunk->left * cellSize, chunk->top * cellSize, cellSize * 0.05f,
+                                   width * cellSize, height * cellSize,
+                                   chunk->left, chunk->top, width, height);
+    }
+    MAZE_PROFILE_ADD(DRAW_CALLS, flatList.size());
+}
+
+void MazeRenderer::drawSolutionTube(const std::vector<std::pair<int, int>>& solution,
+                                    int solutionCount, float cellSize) {
+    if (tubeDirty || cellSize != tubeCellSize) {
+        MAZE_PROFILE_SCOPE("tube mesh");
+        tubeMesh.buildTube(solution, cellSize, cellSize / 2, cellSize);
+        int vertexCount = static_cast<int>(tubeMesh.getNumVertices());
+        MAZE_PROFILE_ADD(VERTICES_BUILT, tubeMesh.getNumVertices());
+        MAZE_PROFILE_ADD(INDICES_BUILT, tubeMesh.getNumIndices());
+        if (vertexCount > 0) {
+            tubeVbo.setVertexData(tubeMesh.vertices.data(), 3, vertexCount, GL_STATIC_DRAW);
+            tubeVbo.setNormalData(tubeMesh.normals.data(), vertexCount, GL_STATIC_DRAW);
+            tubeVbo.setIndexData(tubeMesh.indices.data(), static_cast<int>(tubeMesh.getNumIndices()),
+                                 GL_STATIC_DRAW);
+        }
+
+        // Light samples hover above the tube, evenly spaced along the path
+        pathLights.clear();
+        pathLightSteps.clear();
+        size_t count = std::min(solution.size(), static_cast<size_t>(kMaxPathLights));
+        for (size_t i = 0; i < count; i++) {
+            size_t step = i * solution.size() / count;
+            pathLightSteps.push_back(static_cast<int>(step));
+            pathLights.push_back((solution[step].first + 0.5f) * cellSize);
+            pathLights.push_back((solution[step].second + 0.5f) * cellSize);
+            pathLights.push_back(cellSize * 1.5f);
+        }
+        float spacing = count > 0 ? static_cast<float>(solution.size()) / count : 1.0f;
+        pathLightRadius = std::max(spacing, 3.0f) * cellSize * 1.5f;
+        pathLightsUploaded = false;
+
+        tubeDirty = false;
+        tubeCellSize = cellSize;
+    }
+
+    solutionCount = std::max(0, std::min(solutionCount, static_cast<int>(solution.size())));
+    int indexCount = static_cast<int>(MazeMesh::getTubeIndexCount(solutionCount));
+    if (indexCount > 0) {
+        tubeVbo.drawElements(GL_TRIANGLES, indexCount);
+        MAZE_PROFILE_ADD(DRAW_CALLS, 1);
+    }
+}
+
+void MazeRenderer::applyPathLights(ofShader& shader, int solutionCount) {
+    // Positions only change with the solution; uniforms persist in the program
+    if (!pathLightsUploaded && !pathLights.empty()) {
+        shader.setUniform3fv("pathLights", pathLights.data(),
+                             static_cast<int>(pathLightSteps.size()));
+        pathLightsUploaded = true;
+    }
+    int lit = static_cast<int>(std::lower_bound(pathLightSteps.begin(), pathLightSteps.end(),
+                                                solutionCount) - pathLightSteps.begin());
+    shader.setUniform1i("pathLightCount", lit);
+    shader.setUniform1f("pathLightRadius", pathLightRadius);
+    shader.setUniform3f("pathLightColor", 1.0f, 0.55f, 0.0f);  // Golden orange
+}
+
+void MazeRenderer::drawSearch3D(const MazeGrid& maze, float cellSize) {
+    if (!searchShown) return;
+    prepareTexture(maze, false);
+    uploadTexture();
+    ofSetColor(255);
+    slotTexture.draw(0, 0, cellSize * 0.02f, maze.getSlotWidth() * cellSize,
+                     maze.getSlotHeight() * cellSize);
+    MAZE_PROFILE_ADD(DRAW_CALLS, 1);
+}
+
+void MazeRenderer::draw2D(const MazeGrid& maze, const std::vector<std::pair<int, int>>& solution,
+                          int solutionCount, float cellSize) {
+    solutionCount = std::max(0, std::min(solutionCount, static_cast<int>(solution.size())));
+    prepareTexture(maze, solutionDirty || solutionCount < shadedCount);
+    updateSolution(maze, solution, solutionCount, cellSize);
+    uploadTexture();
+
+    ofSetColor(255);
+    slotTexture.draw(0, 0, maze.getSlotWidth() * cellSize, maze.getSlotHeight() * cellSize);
+    MAZE_PROFILE_ADD(DRAW_CALLS, 1);
+
+    if (solutionCount > 1) {
+        ofSetColor(255, 0, 0);  // Red path
+        ofSetLineWidth(cellSize / 3);
+        solutionLine.draw(GL_LINE_STRIP, 0, solutionCount);
+        MAZE_PROFILE_ADD(DRAW_CALLS, 1);
+    }
+}
+
+void MazeRenderer::markSlotsDirty(const std::vector<std::pair<int, int>>& slots) {
+    if (!textureDirty) {
+        dirtySlots.insert(dirtySlots.end(), slots.begin(), slots.end());
+        // Past a point a full repaint is cheaper than patching texel by texel
+        if (dirtySlots.size() * 16 > slotPixels.getWidth() * slotPixels.getHeight()) {
+            textureDirty = true;
+            dirtySlots.clear();
+        }
+    }
+    if (!wallsDirty && chunksX > 0) {
+        // A slot's faces depend on its neighbours, which may sit in the
+        // next chunk over
+        int chunksY = static_cast<int>(chunks.size()) / chunksX;
+        for (const auto& slot : slots) {
+            for (int dir = -1; dir < 4; dir++) {
+                int x = slot.first + (dir < 0 ? 0 : MazeGrid::kDirX[dir]);
+                int y = slot.second + (dir < 0 ? 0 : MazeGrid::kDirY[dir]);
+                int cx = x / kChunkSlots;
+                int cy = y / kChunkSlots;
+                if (x < 0 || y < 0 || cx >= chunksX || cy >= chunksY) continue;
+                chunkDirty[static_cast<size_t>(cy) * chunksX + cx] = 1;
+            }
+        }
+    }
+}
+
+void MazeRenderer::markSearchDirty(const std::vector<MazeSolver::SearchMark>& marks) {
+    // Painted on the next draw, once the texture matches the grid
+    searchMarks.insert(searchMarks.end(), marks.begin(), marks.end());
+    searchShown = searchShown || !marks.empty();
+}
+
+void MazeRenderer::clearSearch() {
+    std::fill(searchState.begin(), searchState.end(), 0);
+    searchMarks.clear();
+    searchShown = false;
+    textureDirty = true;
+}
+
+//--------------------------------------------------------------
+void MazeRenderer::uploadWalls(const MazeGrid& maze, float cellSize, float wallHeight) {
+    MAZE_PROFILE_SCOPE("wall mesh");
+    chunksX = (maze.getSlotWidth() + kChunkSlots - 1) / kChunkSlots;
+    int chunksY = (maze.getSlotHeight() + kChunkSlots - 1) / kChunkSlots;
+    size_t count = static_cast<size_t>(chunksX) * chunksY;
+    while (chunks.size() > count) chunks.pop_back();
+    while (chunks.size() < count) chunks.push_back(std::make_unique<WallChunk>());
+    chunkDirty.assign(count, 0);
+
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            WallChunk& chunk = *chunks[static_cast<size_t>(cy) * chunksX + cx];
+            chunk.left = cx * kChunkSlots;
+            chunk.top = cy * kChunkSlots;
+            chunk.right = std::min(chunk.left + kChunkSlots, maze.getSlotWidth());
+            chunk.bottom = std::min(chunk.top + kChunkSlots, maze.getSlotHeight());
+            uploadChunk(maze, chunk, cellSize, wallHeight);
+        }
+    }
+    wallsDirty = false;
+    builtCellSize = cellSize;
+    builtWallHeight = wallHeight;
+}
+
+void MazeRenderer::uploadChunk(const MazeGrid& maze, WallChunk& chunk, float cellSize,
+                               float wallHeight) {
+    wallMesh.buildWalls(maze, cellSize, wallHeight,
+                        chunk.left, chunk.top, chunk.right, chunk.bottom);
+    chunk.indexCount = static_cast<int>(wallMesh.getNumIndices());
+    MAZE_PROFILE_ADD(VERTICES_BUILT, wallMesh.getNumVertices());
+    MAZE_PROFILE_ADD(INDICES_BUILT, wallMesh.getNumIndices());
+    if (chunk.indexCount == 0) return;
+    int vertexCount = static_cast<int>(wallMesh.getNumVertices());
+    chunk.vbo.setVertexData(wallMesh.vertices.data(), 3, vertexCount, GL_STATIC_DRAW);
+    chunk.vbo.setNormalData(wallMesh.normals.data(), vertexCount, GL_STATIC_DRAW);
+    chunk.vbo.setIndexData(wallMesh.indices.data(), chunk.indexCount, GL_STATIC_DRAW);
+}
+
+void MazeRenderer::prepareTexture(const MazeGrid& maze, bool repaint) {
+    int slotWidth = maze.getSlotWidth();
+    int slotHeight = maze.getSlotHeight();
+    if (!slotTexture.isAllocated() ||
+        slotTexture.getWidth() != slotWidth || slotTexture.getHeight() != slotHeight) {
+        slotPixels.allocate(slotWidth, slotHeight, OF_PIXELS_RGBA);
+        slotTexture.allocate(slotWidth, slotHeight, GL_RGBA);
+        slotTexture.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+        searchState.assign(static_cast<size_t>(slotWidth) * slotHeight, 0);
+        textureDirty = true;
+    }
+    if (textureDirty || repaint) {
+        MAZE_PROFILE_SCOPE("texture paint");
+        for (const auto& mark : searchMarks) {
+            if (!maze.inBounds(mark.x, mark.y)) continue;
+            searchState[static_cast<size_t>(mark.y) * slotWidth + mark.x] =
+                static_cast<uint8_t>(mark.state);
+        }
+        searchMarks.clear();
+        paintSlots(maze, 0, slotHeight);
+        shadedCount = 0;
+        textureDirty = true;
+        dirtySlots.clear();
+        return;
+    }
+
+    // Patch single texels and upload only the rows they span
+    if (dirtySlots.empty() && searchMarks.empty()) return;
+    int y0 = slotHeight;
+    int y1 = 0;
+    unsigned char* data = slotPixels.getData();
+    for (const auto& slot : dirtySlots) {
+        int x = slot.first;
+        int y = slot.second;
+        if (!maze.inBounds(x, y)) continue;
+        size_t index = static_cast<size_t>(y) * slotWidth + x;
+        paintTexel(data + index * 4, maze.isWall(x, y), searchState[index]);
+        y0 = std::min(y0, y);
+        y1 = std::max(y1, y + 1);
+    }
+    for (const auto& mark : searchMarks) {
+        if (!maze.inBounds(mark.x, mark.y)) continue;
+        size_t index = static_cast<size_t>(mark.y) * slotWidth + mark.x;
+        searchState[index] = static_cast<uint8_t>(mark.state);
+        paintTexel(data + index * 4, maze.isWall(mark.x, mark.y), searchState[index]);
+        y0 = std::min(y0, mark.y);
+        y1 = std::max(y1, mark.y + 1);
+    }
+    dirtySlots.clear();
+    searchMarks.clear();
+    uploadRows(y0, y1);
+}
+
+void MazeRenderer::uploadTexture() {
+    if (!textureDirty) return;
+    uploadRows(0, static_cast<int>(slotPixels.getHeight()));
+    textureDirty = false;
+}
+
+void MazeRenderer::paintSlots(const MazeGrid& maze, int y0, int y1) {
+    int slotWidth = maze.getSlotWidth();
+    unsigned char* data = slotPixels.getData();
+    for (int y = y0; y < y1; y++) {
+        const MazeGrid::Word* words = maze.row(y);
+        size_t index = static_cast<size_t>(y) * slotWidth;
+        for (int x = 0; x < slotWidth; x++, index++) {
+            bool wall = (words[x / MazeGrid::kWordBits] >> (x % MazeGrid::kWordBits)) & 1;
+            paintTexel(data + index * 4, wall, searchState[index]);
+        }
+    }
+}
+
+void MazeRenderer::uploadRows(int y0, int y1) {
+    // Only the changed rows go to the GPU; they are contiguous in slotPixels
+    if (y1 <= y0) return;
+    MAZE_PROFILE_SCOPE("texture upload");
+    const ofTextureData& texData = slotTexture.getTextureData();
+    int slotWidth = static_cast<int>(slotPixels.getWidth());
+    glBindTexture(texData.textureTarget, texData.textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(texData.textureTarget, 0, 0, y0, slotWidth, y1 - y0, GL_RGBA, GL_UNSIGNED_BYTE,
+                    slotPixels.getData() + static_cast<size_t>(y0) * slotWidth * 4);
+    glBindTexture(texData.textureTarget, 0);
+}
+
+void MazeRenderer::updateSolution(const MazeGrid& maze,
+                                  const std::vector<std::pair<int, int>>& solution,
+                                  int solutionCount, float cellSize) {
+    if (solutionDirty || cellSize != linesCellSize) {
+        solutionPoints.resize(solution.size() * 3);
+        for (size_t i = 0; i < solution.size(); i++) {
+            solutionPoints[i * 3] = (solution[i].first + 0.5f) * cellSize;
+            solutionPoints[i * 3 + 1] = (solution[i].second + 0.5f) * cellSize;
+            solutionPoints[i * 3 + 2] = 0;
+        }
+        if (!solution.empty()) {
+            solutionLine.setVertexData(solutionPoints.data(), 3, static_cast<int>(solution.size()),
+                                       GL_STATIC_DRAW);
+        }
+        solutionDirty = false;
+        linesCellSize = cellSize;
+    }
+
+    // Shade the newly revealed solution slots and upload just their rows
+    if (solutionCount <= shadedCount) return;
+    int slotWidth = maze.getSlotWidth();
+    int y0 = maze.getSlotHeight();
+    int y1 = 0;
+    unsigned char* data = slotPixels.getData();
+    for (int i = shadedCount; i < solutionCount; i++) {
+        int x = solution[i].first;
+        int y = solution[i].second;
+        unsigned char* texel = data + (static_cast<size_t>(y) * slotWidth + x) * 4;
+        texel[0] = kSolutionCellColor.r;
+        texel[1] = kSolutionCellColor.g;
+        texel[2] = kSolutionCellColor.b;
+        texel[3] = 255;
+        y0 = std::min(y0, y);
+        y1 = std::max(y1, y + 1);
+    }
+    shadedCount = solutionCount;
+    if (!textureDirty) {
+        uploadRows(y0, y1);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MazeGrid.h"
+#include "MazeMesh.h"
+#include "MazeSolver.h"
+
+// GPU-side drawing of a MazeGrid for the viewer.
+//
+// Wall geometry is meshed on the CPU only when the maze changes (or the
+// cell size / wall height differ from the last build) and kept in static
+// VBOs, one per square chunk of slots. Each frame the chunks are culled
+// against the current camera frustum, and chunks beyond the LOD distance
+// are drawn as flat quads of the 2D slot texture instead of walls.
+//
+// During animation markSlotsDirty() keeps updates proportional to the
+// change: only the touched texel rows and wall chunks are re-uploaded.
+//
+// The 2D view uploads the grid as a texture with one texel per slot and
+// nearest filtering, so the maze and the shaded solution cells are one
+// textured quad and the solution line is one line strip. A stepped solver
+// search is painted into the same texture, slot by slot as it advances.
+class MazeRenderer {
+public:
+    MazeRenderer();
+
+    // Call whenever the grid contents change; the next draw rebuilds
+    void markDirty() {
+        wallsDirty = true;
+        dirtySlots.clear();
+        clearSearch();
+    }
+    // Cheaper alternative when only a few slots changed: the next draw
+    // repaints those texels and remeshes only the chunks around them
+    void markSlotsDirty(const std::vector<std::pair<int, int>>& slots);
+    // Call whenever the solution path is replaced or cleared
+    void markSolutionDirty() { solutionDirty = true; tubeDirty = true; }
+    bool isDirty() const { return wallsDirty || textureDirty; }
+    // Slots whose solver search state changed; the next draw paints them
+    void markSearchDirty(const std::vector<MazeSolver::SearchMark>& marks);
+    // Drop the search overlay
+    void clearSearch();
+    bool hasSearch() const { return searchShown; }
+
+    // Uses the current projection and modelview matrices for culling
+    void drawWalls3D(const MazeGrid& maze, float cellSize, float wallHeight);
+    // Distance in slots beyond which chunks are drawn flat; 0 disables LOD
+    void setLodDistance(float slots) { lodDistance = slots; }
+    float getLodDistance() const { return lodDistance; }
+    // Statistics of the last drawWalls3D call
+    size_t getChunkCount() const { return chunks.size(); }
+    int getVisibleChunkCount() const { return visibleChunks; }
+    int getFlatChunkCount() const { return flatChunks; }
+    // Solution tube through the first solutionCount steps, meshed once per
+    // solution into an indexed VBO
+    void drawSolutionTube(const std::vector<std::pair<int, int>>& solution, int solutionCount,
+                          float cellSize);
+    // Set the glow shader's path light uniforms (shader must be bound).
+    // Light samples are spread evenly along the whole solution when the
+    // tube is built; only those within the first solutionCount steps shine.
+    void applyPathLights(ofShader& shader, int solutionCount);
+    // Search overlay as a decal on the 3D floor
+    void drawSearch3D(const MazeGrid& maze, float cellSize);
+    // Draw the maze with the first solutionCount steps of the solution
+    void draw2D(const MazeGrid& maze, const std::vector<std::pair<int, int>>& solution,
+                int solutionCount, float cellSize);
+
+private:
+    static const int kChunkSlots = 64;
+
+    struct WallChunk {
+        ofVbo vbo;
+        int indexCount = 0;
+        int left, top, right, bottom;  // slot bounds
+    };
+
+    MazeMesh wallMesh;  // scratch for building one chunk at a time
+    std::vector<std::unique_ptr<WallChunk>> chunks;
+    int chunksX;
+    std::vector<uint8_t> chunkDirty;
+    float lodDistance;
+    int visibleChunks;
+    int flatChunks;
+    std::vector<const WallChunk*> flatList;
+    bool wallsDirty;
+    float builtCellSize;
+    float builtWallHeight;
+
+    // 2D: RGBA texel per slot, plus the solution as slot-centre points
+    ofPixels slotPixels;
+    ofTexture slotTexture;
+    bool textureDirty;
+    bool solutionDirty;
+    int shadedCount;  // solution slots currently painted into slotPixels
+    ofVbo solutionLine;
+    std::vector<float> solutionPoints;
+    float linesCellSize;
+    // 3D solution tube
+    MazeMesh tubeMesh;
+    ofVbo tubeVbo;
+    bool tubeDirty;
+    float tubeCellSize;
+    // Must match MAX_PATH_LIGHTS in shaders/glow.frag
+    static const int kMaxPathLights = 64;
+    std::vector<float> pathLights;       // x, y, z per light
+    std::vector<int> pathLightSteps;     // solution index of each light
+    float pathLightRadius;
+    bool pathLightsUploaded;
+
+    // Slots changed since the texture was last synced
+    std::vector<std::pair<int, int>> dirtySlots;
+    // Search overlay: CellState per slot, and marks not painted yet
+    std::vector<uint8_t> searchState;
+    std::vector<MazeSolver::SearchMark> searchMarks;
+    bool searchShown;
+
+    void uploadWalls(const MazeGrid& maze, float cellSize, float wallHeight);
+    void uploadChunk(const MazeGrid& maze, WallChunk& chunk, float cellSize, float wallHeight);
+    // Match the texture to the grid, repainting everything if the grid (or,
+    // with repaint, the solution) changed; uploadTexture() then flushes it
+    void prepareTexture(const MazeGrid& maze, bool repaint);
+    void uploadTexture();
+    void paintSlots(const MazeGrid& maze, int y0, int y1);
+    void uploadRows(int y0, int y1);
+    void updateSolution(const MazeGrid& maze, const std::vector<std::pair<int, int>>& solution,
+                        int solutionCount, float cellSize);
+};
@@ -1,50 +1,529 @@
 #include "MazeSolver.h"
-#include <deque>
-#include <set>
+#include <algorithm>
+#include <cstdlib>
+#include "MazeProfiler.h"
 
-MazeSolver::MazeSolver() {}
+const uint8_t MazeSolver::kUnvisited;
+const uint8_t MazeSolver::kBlocked;
+const uint8_t MazeSolver::kRoot;
 
-void MazeSolver::solve(const vector<vector<int>>& maze, int width, int height) {
+MazeSolver::MazeSolver(Algorithm algorithm)
+    : algorithm(algorithm), searching(false), recording(false), found(false), startCells(),
+      goalCells(), forward(true), levelLeft(0), openF(0), filling(false), followX(0),
+      followY(0), heading(MazeGrid::SOUTH), moves(0), cancelFlag(nullptr),
+      expanded(0), peakFrontier(0) {}
+
+const char* MazeSolver::getAlgorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::BFS: return "Breadth-First Search";
+        case Algorithm::BIDIRECTIONAL_BFS: return "Bidirectional BFS";
+        case Algorithm::A_STAR: return "A*";
+        case Algorithm::DEAD_END_FILLING: return "Dead-End Filling";
+        case Algorithm::WALL_FOLLOWER: return "Wall Follower";
+    }
+    return "";
+}
+
+void MazeSolver::solve(const MazeGrid& maze) {
+    solve(maze, {1, 0}, {2 * maze.getWidth() - 1, 2 * maze.getHeight()});
+}
+
+void MazeSolver::solve(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal) {
+    MAZE_PROFILE_SCOPE("solve");
+    // Same start/step pairs as the animation, looped without the dispatch
+    recording = false;
+    if (!startSearch(maze, start, goal)) return;
+    switch (algorithm) {
+        case Algorithm::BFS:
+            while (stepBfs(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::BIDIRECTIONAL_BFS:
+            while (stepBidirectional(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::A_STAR:
+            while (stepAStar(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::DEAD_END_FILLING:
+            while (stepDeadEndFilling(maze) && !isCancelled()) {}
+            break;
+        case Algorithm::WALL_FOLLOWER:
+            while (stepWallFollower(maze) && !isCancelled()) {}
+            break;
+    }
+    if (isCancelled()) found = false;
+    finishSearch(maze);
+}
+
+void MazeSolver::begin(const MazeGrid& maze) {
+    begin(maze, {1, 0}, {2 * maze.getWidth() - 1, 2 * maze.getHeight()});
+}
+
+void MazeSolver::begin(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal) {
+    recording = true;
+    searchMarks.clear();
+    startSearch(maze, start, goal);
+}
+
+bool MazeSolver::step(const MazeGrid& maze) {
+    if (!searching) return false;
+
+    bool more = false;
+    switch (algorithm) {
+        case Algorithm::BFS:
+            more = stepBfs(maze);
+            break;
+        case Algorithm::BIDIRECTIONAL_BFS:
+            more = stepBidirectional(maze);
+            break;
+        case Algorithm::A_STAR:
+            more = stepAStar(maze);
+            break;
+        case Algorithm::DEAD_END_FILLING:
+            more = stepDeadEndFilling(maze);
+            break;
+        case Algorithm::WALL_FOLLOWER:
+            more = stepWallFollower(maze);
+            break;
+    }
+    if (!more) finishSearch(maze);
+    return more;
+}
+
+void MazeSolver::finishSearch(const MazeGrid& maze) {
+    searching = false;
+    MAZE_PROFILE_SET(NODES_EXPANDED, expanded);
+    MAZE_PROFILE_SET(PEAK_QUEUE, peakFrontier);
+    if (found) {
+        buildSolution(maze, startSlot, goalSlot);
+    }
+}
+
+bool MazeSolver::startSearch(const MazeGrid& maze, std::pair<int, int> start,
+                             std::pair<int, int> goal) {
     solution.clear();
-    
-    pair<int, int> start = {1, 0};
-    pair<int, int> end = {2 * width - 1, 2 * height};
-    
-    deque<pair<pair<int, int>, vector<pair<int, int>>>> queue;
-    set<pair<int, int>> visited;
-    
-    queue.push_back({start, {start}});
-    visited.insert(start);
-    
-    vector<pair<int, int>> moves = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-    
-    while (!queue.empty()) {
-        auto current = queue.front().first;
-        auto path = queue.front().second;
-        queue.pop_front();
-        
-        if (current == end) {
-            solution = path;
-            return;
-        }
-        
-        for (const auto& move : moves) {
-            int next_x = current.first + move.first;
-            int next_y = current.second + move.second;
-            
-            if (isValid(next_x, next_y, width, height) && 
-                maze[next_y][next_x] == 0 && 
-                visited.find({next_x, next_y}) == visited.end()) {
-                
-                auto new_path = path;
-                new_path.push_back({next_x, next_y});
-                queue.push_back({{next_x, next_y}, new_path});
-                visited.insert({next_x, next_y});
+    pathCells.clear();
+    searching = false;
+    found = false;
+    expanded = 0;
+    peakFrontier = 0;
+    if (maze.getWidth() == 0 || maze.getHeight() == 0) return false;
+    if (!maze.inBounds(start.first, start.second) || maze.isWall(start.first, start.second) ||
+        !maze.inBounds(goal.first, goal.second) || maze.isWall(goal.first, goal.second)) {
+        return false;
+    }
+
+    slotToCells(maze, start.first, start.second, startCells);
+    slotToCells(maze, goal.first, goal.second, goalCells);
+    startSlot = start;
+    goalSlot = goal;
+    searching = true;
+
+    switch (algorithm) {
+        case Algorithm::BFS:
+            startBfs(maze);
+            break;
+        case Algorithm::BIDIRECTIONAL_BFS:
+            startBidirectional(maze);
+            break;
+        case Algorithm::A_STAR:
+            startAStar(maze);
+            break;
+        case Algorithm::DEAD_END_FILLING:
+            startDeadEndFilling(maze);
+            break;
+        case Algorithm::WALL_FOLLOWER:
+            startWallFollower(maze);
+            break;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+void MazeSolver::startBfs(const MazeGrid& maze) {
+    parentDir.assign(maze.getCellCount(), kUnvisited);
+    seedBfs(maze);
+}
+
+void MazeSolver::seedBfs(const MazeGrid& maze) {
+    queue.clear();
+    for (uint32_t cell : startCells) {
+        if (parentDir[cell] != kUnvisited) continue;
+        parentDir[cell] = kRoot;
+        queue.push(cell);
+        mark(maze, cell, -1, CellState::FRONTIER);
+    }
+}
+
+bool MazeSolver::stepBfs(const MazeGrid& maze) {
+    if (queue.empty()) return false;
+    int width = maze.getWidth();
+    uint32_t cell = queue.pop();
+    expanded++;
+    if (isGoal(cell)) {
+        traceBack(maze, parentDir, cell);
+        std::reverse(pathCells.begin(), pathCells.end());
+        found = true;
+        return false;
+    }
+    mark(maze, cell, parentDir[cell] == kRoot ? -1 : parentDir[cell], CellState::VISITED);
+
+    int cx = cell % width;
+    int cy = cell / width;
+    for (int dir = 0; dir < 4; dir++) {
+        if (!maze.hasNeighbor(cx, cy, dir) || !maze.canMove(cx, cy, dir)) continue;
+        uint32_t next = static_cast<uint32_t>(
+            maze.cellIndex(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir]));
+        if (parentDir[next] != kUnvisited) continue;
+        parentDir[next] = static_cast<uint8_t>(dir);
+        queue.push(next);
+        mark(maze, next, dir, CellState::FRONTIER);
+    }
+    notePeak(queue.size());
+    return !queue.empty();
+}
+
+void MazeSolver::startBidirectional(const MazeGrid& maze) {
+    parentDir.assign(maze.getCellCount(), kUnvisited);
+    parentDirBack.assign(maze.getCellCount(), kUnvisited);
+    queue.clear();
+    queueBack.clear();
+    for (int i = 0; i < 2; i++) {
+        if (parentDir[startCells[i]] == kUnvisited) {
+            parentDir[startCells[i]] = kRoot;
+            queue.push(startCells[i]);
+            mark(maze, startCells[i], -1, CellState::FRONTIER);
+        }
+        if (parentDirBack[goalCells[i]] == kUnvisited) {
+            parentDirBack[goalCells[i]] = kRoot;
+            queueBack.push(goalCells[i]);
+            mark(maze, goalCells[i], -1, CellState::FRONTIER);
+        }
+    }
+    levelLeft = 0;
+}
+
+bool MazeSolver::stepBidirectional(const MazeGrid& maze) {
+    // Endpoints that share a cell meet there at once
+    for (uint32_t cell : startCells) {
+        if (isGoal(cell)) return meetAt(maze, cell);
+    }
+
+    // Expand whole levels, always on the smaller side. The first contact
+    // is already a shortest route: the touched cell must still be on the
+    // other side's frontier, so every contact in this level has the same
+    // length.
+    if (levelLeft == 0) {
+        if (queue.empty() || queueBack.empty()) return false;
+        forward = queue.size() <= queueBack.size();
+        levelLeft = forward ? queue.size() : queueBack.size();
+    }
+    int width = maze.getWidth();
+    CellQueue& frontier = forward ? queue : queueBack;
+    std::vector<uint8_t>& mine = forward ? parentDir : parentDirBack;
+    const std::vector<uint8_t>& other = forward ? parentDirBack : parentDir;
+
+    uint32_t cell = frontier.pop();
+    levelLeft--;
+    expanded++;
+    mark(maze, cell, mine[cell] == kRoot ? -1 : mine[cell], CellState::VISITED);
+    int cx = cell % width;
+    int cy = cell / width;
+    for (int dir = 0; dir < 4; dir++) {
+        if (!maze.hasNeighbor(cx, cy, dir) || !maze.canMove(cx, cy, dir)) continue;
+        uint32_t next = static_cast<uint32_t>(
+            maze.cellIndex(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir]));
+        if (mine[next] != kUnvisited) continue;
+        mine[next] = static_cast<uint8_t>(dir);
+        if (other[next] != kUnvisited) {
+            mark(maze, next, dir, CellState::VISITED);
+            return meetAt(maze, next);
+        }
+        frontier.push(next);
+        mark(maze, next, dir, CellState::FRONTIER);
+    }
+    notePeak(queue.size() + queueBack.size());
+    return true;
+}
+
+bool MazeSolver::meetAt(const MazeGrid& maze, uint32_t cell) {
+    traceBack(maze, parentDir, cell);
+    std::reverse(pathCells.begin(), pathCells.end());
+    pathCells.pop_back();
+    traceBack(maze, parentDirBack, cell);
+    found = true;
+    return false;
+}
+
+void MazeSolver::startAStar(const MazeGrid& maze) {
+    // With unit steps and a Manhattan heuristic every move keeps f the same
+    // or raises it by exactly two, and the two cells of a passage start
+    // differ by one. Open f values therefore stay within openF .. openF + 2,
+    // and three LIFO buckets indexed by f mod 3 replace a heap.
+    parentDir.assign(maze.getCellCount(), kUnvisited);
+    cost.assign(maze.getCellCount(), UINT32_MAX);
+    for (auto& bucket : openBuckets) bucket.clear();
+
+    openF = UINT32_MAX;
+    for (uint32_t cell : startCells) {
+        if (cost[cell] == 0) continue;
+        parentDir[cell] = kRoot;
+        cost[cell] = 0;
+        uint32_t f = heuristic(maze, cell);
+        openBuckets[f % 3].push_back(cell);
+        openF = std::min(openF, f);
+        mark(maze, cell, -1, CellState::FRONTIER);
+    }
+}
+
+bool MazeSolver::stepAStar(const MazeGrid& maze) {
+    int width = maze.getWidth();
+    while (true) {
+        std::vector<uint32_t>& bucket = openBuckets[openF % 3];
+        if (bucket.empty()) {
+            if (openBuckets[0].empty() && openBuckets[1].empty() && openBuckets[2].empty()) {
+                return false;
+            }
+            openF++;
+            continue;
+        }
+        uint32_t cell = bucket.back();
+        bucket.pop_back();
+        // Stale entry: the cell was reached more cheaply after it was queued
+        if (cost[cell] + heuristic(maze, cell) != openF) continue;
+        expanded++;
+        if (isGoal(cell)) {
+            traceBack(maze, parentDir, cell);
+            std::reverse(pathCells.begin(), pathCells.end());
+            found = true;
+            return false;
+        }
+        mark(maze, cell, parentDir[cell] == kRoot ? -1 : parentDir[cell], CellState::VISITED);
+
+        int cx = cell % width;
+        int cy = cell / width;
+        uint32_t nextCost = cost[cell] + 1;
+        for (int dir = 0; dir < 4; dir++) {
+            if (!maze.hasNeighbor(cx, cy, dir) || !maze.canMove(cx, cy, dir)) continue;
+            uint32_t next = static_cast<uint32_t>(
+                maze.cellIndex(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir]));
+            if (nextCost >= cost[next]) continue;
+            cost[next] = nextCost;
+            parentDir[next] = static_cast<uint8_t>(dir);
+            openBuckets[(nextCost + heuristic(maze, next)) % 3].push_back(next);
+            mark(maze, next, dir, CellState::FRONTIER);
+        }
+        notePeak(openBuckets[0].size() + openBuckets[1].size() + openBuckets[2].size());
+        return true;
+    }
+}
+
+uint32_t MazeSolver::heuristic(const MazeGrid& maze, uint32_t cell) const {
+    // Manhattan distance in cells to the nearest goal cell: half the slot
+    // distance to the goal slot, rounded down
+    int width = maze.getWidth();
+    int x = 2 * static_cast<int>(cell % width) + 1;
+    int y = 2 * static_cast<int>(cell / width) + 1;
+    return static_cast<uint32_t>(
+        (std::abs(x - goalSlot.first) + std::abs(y - goalSlot.second)) / 2);
+}
+
+void MazeSolver::startDeadEndFilling(const MazeGrid& maze) {
+    // Count open passages per cell. A serial pass: it is cheap next to the
+    // fill, and the shared pool would queue it behind any batch or tiled
+    // build in progress.
+    int width = maze.getWidth();
+    int height = maze.getHeight();
+    degree.resize(maze.getCellCount());
+    for (int cy = 0; cy < height; cy++) {
+        for (int cx = 0; cx < width; cx++) {
+            uint8_t d = 0;
+            for (int dir = 0; dir < 4; dir++) {
+                d += maze.hasNeighbor(cx, cy, dir) && maze.canMove(cx, cy, dir);
             }
+            degree[maze.cellIndex(cx, cy)] = d;
+        }
+    }
+
+    parentDir.assign(maze.getCellCount(), kUnvisited);
+    deadEnds.clear();
+    for (size_t i = 0; i < degree.size(); i++) {
+        uint32_t cell = static_cast<uint32_t>(i);
+        if (degree[i] <= 1 && !isStart(cell) && !isGoal(cell)) deadEnds.push_back(cell);
+    }
+    notePeak(deadEnds.size());
+    filling = true;
+}
+
+bool MazeSolver::stepDeadEndFilling(const MazeGrid& maze) {
+    if (!filling) return stepBfs(maze);
+    if (deadEnds.empty()) {
+        // A perfect maze is now a single corridor; braided ones may keep loops
+        filling = false;
+        seedBfs(maze);
+        return true;
+    }
+
+    // Fill dead ends until only junctions and the route remain
+    int width = maze.getWidth();
+    uint32_t cell = deadEnds.back();
+    deadEnds.pop_back();
+    expanded++;
+    parentDir[cell] = kBlocked;
+    mark(maze, cell, -1, CellState::DEAD);
+    int cx = cell % width;
+    int cy = cell / width;
+    for (int dir = 0; dir < 4; dir++) {
+        if (!maze.hasNeighbor(cx, cy, dir) || !maze.canMove(cx, cy, dir)) continue;
+        uint32_t next = static_cast<uint32_t>(
+            maze.cellIndex(cx + MazeGrid::kDirX[dir], cy + MazeGrid::kDirY[dir]));
+        if (parentDir[next] == kBlocked) continue;
+        // The passage towards the rest of the maze is dead as well
+        mark(maze, cell, MazeGrid::opposite(dir), CellState::DEAD);
+        if (--degree[next] == 1 && !isStart(next) && !isGoal(next)) deadEnds.push_back(next);
+    }
+    notePeak(deadEnds.size());
+    return true;
+}
+
+void MazeSolver::startWallFollower(const MazeGrid& maze) {
+    int width = maze.getWidth();
+    // A passage start is left through its west/north cell
+    followX = startCells[0] % width;
+    followY = startCells[0] / width;
+    heading = MazeGrid::SOUTH;
+    moves = 0;
+    pathCells.push_back(startCells[0]);
+    mark(maze, startCells[0], -1, CellState::VISITED);
+}
+
+bool MazeSolver::stepWallFollower(const MazeGrid& maze) {
+    // Keep a hand on the left wall. Stepping straight back onto the
+    // previous cell pops it, so perfect mazes yield the exact route.
+    uint32_t cell = static_cast<uint32_t>(maze.cellIndex(followX, followY));
+    if (isGoal(cell)) {
+        found = true;
+        return false;
+    }
+    bool looped = moves > 0 && cell == startCells[0] && heading == MazeGrid::SOUTH;
+    if (looped || moves >= 4 * maze.getCellCount() + 4) {
+        pathCells.clear();
+        return false;
+    }
+
+    // Try left, straight, right, back
+    bool moved = false;
+    for (int turn : {3, 0, 1, 2}) {
+        int dir = (heading + turn) % 4;
+        if (maze.hasNeighbor(followX, followY, dir) && maze.canMove(followX, followY, dir)) {
+            heading = dir;
+            moved = true;
+            break;
         }
     }
+    if (!moved) {
+        pathCells.clear();
+        return false;
+    }
+
+    followX += MazeGrid::kDirX[heading];
+    followY += MazeGrid::kDirY[heading];
+    moves++;
+    expanded++;
+    uint32_t next = static_cast<uint32_t>(maze.cellIndex(followX, followY));
+    if (pathCells.size() >= 2 && pathCells[pathCells.size() - 2] == next) {
+        mark(maze, cell, MazeGrid::opposite(heading), CellState::DEAD);
+        pathCells.pop_back();
+    } else {
+        mark(maze, next, heading, CellState::VISITED);
+        pathCells.push_back(next);
+        notePeak(pathCells.size());
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+void MazeSolver::CellQueue::push(uint32_t cell) {
+    if (count == ring.size()) {
+        // Grow and unwrap so the live range starts at 0 again
+        std::vector<uint32_t> grown(std::max<size_t>(1024, ring.size() * 2));
+        for (size_t i = 0; i < count; i++) {
+            grown[i] = ring[(head + i) & (ring.size() - 1)];
+        }
+        ring.swap(grown);
+        head = 0;
+    }
+    ring[(head + count) & (ring.size() - 1)] = cell;
+    count++;
+}
+
+uint32_t MazeSolver::CellQueue::pop() {
+    uint32_t cell = ring[head];
+    head = (head + 1) & (ring.size() - 1);
+    count--;
+    return cell;
+}
+
+void MazeSolver::traceBack(const MazeGrid& maze, const std::vector<uint8_t>& parents,
+                           uint32_t cell) {
+    int width = maze.getWidth();
+    pathCells.push_back(cell);
+    while (parents[cell] != kRoot) {
+        int dir = parents[cell];
+        int cx = cell % width - MazeGrid::kDirX[dir];
+        int cy = cell / width - MazeGrid::kDirY[dir];
+        cell = static_cast<uint32_t>(maze.cellIndex(cx, cy));
+        pathCells.push_back(cell);
+    }
 }
 
-bool MazeSolver::isValid(int x, int y, int width, int height) const {
-    return x >= 0 && x < (2 * width + 1) && y >= 0 && y < (2 * height + 1);
+void MazeSolver::mark(const MazeGrid& maze, uint32_t cell, int dir, CellState state) {
+    if (!recording) return;
+    int width = maze.getWidth();
+    int x = 2 * static_cast<int>(cell % width) + 1;
+    int y = 2 * static_cast<int>(cell / width) + 1;
+    searchMarks.push_back({x, y, state});
+    if (dir >= 0) {
+        searchMarks.push_back({x - MazeGrid::kDirX[dir], y - MazeGrid::kDirY[dir], state});
+    }
+}
+
+void MazeSolver::slotToCells(const MazeGrid& maze, int x, int y, uint32_t cells[2]) {
+    // Border slots belong to the cell inside them; passage slots join the
+    // cell on their west/north side to the one on their east/south side.
+    int cx = (std::min(std::max(x, 1), maze.getSlotWidth() - 2) - 1) / 2;
+    int cy = (std::min(std::max(y, 1), maze.getSlotHeight() - 2) - 1) / 2;
+    cells[0] = cells[1] = static_cast<uint32_t>(maze.cellIndex(cx, cy));
+    bool insideX = x > 0 && x < maze.getSlotWidth() - 1;
+    bool insideY = y > 0 && y < maze.getSlotHeight() - 1;
+    if (insideX && insideY && x % 2 == 0 && y % 2 == 1) {
+        cells[1] = static_cast<uint32_t>(maze.cellIndex(cx + 1, cy));
+    } else if (insideX && insideY && x % 2 == 1 && y % 2 == 0) {
+        cells[1] = static_cast<uint32_t>(maze.cellIndex(cx, cy + 1));
+    }
+}
+
+void MazeSolver::buildSolution(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal) {
+    int width = maze.getWidth();
+    solution.reserve(2 * pathCells.size() + 1);
+
+    int x = 2 * static_cast<int>(pathCells.front() % width) + 1;
+    int y = 2 * static_cast<int>(pathCells.front() / width) + 1;
+    if (start != std::make_pair(x, y)) solution.push_back(start);
+    for (size_t i = 0; i < pathCells.size(); i++) {
+        x = 2 * static_cast<int>(pathCells[i] % width) + 1;
+        y = 2 * static_cast<int>(pathCells[i] / width) + 1;
+        if (i > 0) {
+            // Passage slot between the previous cell and this one
+            solution.push_back({(solution.back().first + x) / 2, (solution.back().second + y) / 2});
+        }
+        solution.push_back({x, y});
+    }
+    if (solution.back() != goal) solution.push_back(goal);
+
+    // The wall follower leaves a passage start through one fixed cell, and
+    // a passage that is both start and goal is reached through a cell; drop
+    // the detour into that cell and back
+    if (solution.size() >= 3 && solution[0] == solution[2]) {
+        solution.erase(solution.begin(), solution.begin() + 2);
+    }
 }
@@ -1,15 +1,164 @@
 #pragma once
-#include "ofMain.h"
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "MazeGrid.h"
 
 class MazeSolver {
 public:
-    MazeSolver();
-    void solve(const vector<vector<int>>& maze, int width, int height);
-    const vector<pair<int, int>>& getSolution() const { return solution; }
+    enum class Algorithm {
+        BFS,                // shortest path, one frontier
+        BIDIRECTIONAL_BFS,  // shortest path, frontiers grown from both ends
+        A_STAR,             // shortest path, Manhattan heuristic, two-bucket open list
+        DEAD_END_FILLING,   // prune dead ends, then BFS what is left
+        WALL_FOLLOWER       // left-hand rule, constant memory, not shortest on braids
+    };
+
+    // Search state of a slot, for visualising a stepped search
+    enum class CellState : uint8_t {
+        NONE,
+        FRONTIER,  // queued, not expanded yet
+        VISITED,   // expanded
+        DEAD       // pruned by dead-end filling, or left by the wall follower
+    };
+    struct SearchMark {
+        int x, y;  // slot
+        CellState state;
+    };
+
+    MazeSolver(Algorithm algorithm = Algorithm::BFS);
+    ~MazeSolver() = default;
+
+    void setAlgorithm(Algorithm algorithm) { this->algorithm = algorithm; }
+    Algorithm getAlgorithm() const { return algorithm; }
+    static const char* getAlgorithmName(Algorithm algorithm);
+
+    // Solve from the entrance {1, 0} to the exit {2W-1, 2H}.
+    void solve(const MazeGrid& maze);
+    // Solve between two open slots. Border openings are attached to the
+    // cell inside them; the search leaves a passage slot through either of
+    // its cells, and reaches one through either. Buffers are kept between
+    // calls, so repeated solves do not allocate.
+    void solve(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal);
+    const std::vector<std::pair<int, int>>& getSolution() const { return solution; }
     void clear() { solution.clear(); }
-    
+    // solve() gives up, with no solution, once *flag is set (nullptr disables)
+    void setCancelFlag(const std::atomic<bool>* flag) { cancelFlag = flag; }
+
+    // Incremental search for animation: begin() starts a search and each
+    // step() expands one cell (one dead end filled, one wall-follower move),
+    // returning false once the search is over. getSolution() then holds the
+    // same path solve() finds. Every slot whose state changes is recorded
+    // in getSearchMarks() until cleared.
+    void begin(const MazeGrid& maze);
+    void begin(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal);
+    bool step(const MazeGrid& maze);
+    bool isSearching() const { return searching; }
+    const std::vector<SearchMark>& getSearchMarks() const { return searchMarks; }
+    void clearSearchMarks() { searchMarks.clear(); }
+
 private:
-    vector<pair<int, int>> solution;
-    bool isValid(int x, int y, int width, int height) const;
-    ~MazeSolver() = default;
+    static const uint8_t kUnvisited = 0xFF;
+    static const uint8_t kBlocked = 0xFE;
+    static const uint8_t kRoot = 0xFD;
+
+    // FIFO of cell indices, power-of-two ring grown on demand
+    struct CellQueue {
+        std::vector<uint32_t> ring;
+        size_t head = 0;
+        size_t count = 0;
+
+        void clear() { head = 0; count = 0; }
+        bool empty() const { return count == 0; }
+        size_t size() const { return count; }
+        void push(uint32_t cell);
+        uint32_t pop();
+    };
+
+    Algorithm algorithm;
+    std::vector<std::pair<int, int>> solution;
+    // Direction taken to reach each cell, kUnvisited if not reached yet and
+    // kRoot for the cells the search starts from
+    std::vector<uint8_t> parentDir;
+    std::vector<uint8_t> parentDirBack;
+    CellQueue queue;
+    CellQueue queueBack;
+    // A* cost so far and the open buckets, indexed by f mod 3
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> openBuckets[3];
+    // Dead-end filling: cells left with one passage, and passages per cell
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint8_t> degree;
+    // Cells of the found route, start to goal
+    std::vector<uint32_t> pathCells;
+
+    // Search in progress; marks are only recorded for begin()/step() runs
+    bool searching;
+    bool recording;
+    bool found;
+    // Cells next to each endpoint: the same cell twice, or both cells of a
+    // passage slot
+    uint32_t startCells[2];
+    uint32_t goalCells[2];
+    std::pair<int, int> startSlot;
+    std::pair<int, int> goalSlot;
+    // Bidirectional: side being expanded and cells left in its level
+    bool forward;
+    size_t levelLeft;
+    // A*: lowest f that may still be open
+    uint32_t openF;
+    // Dead-end filling: still pruning, BFS afterwards
+    bool filling;
+    // Wall follower position, heading and moves so far
+    int followX;
+    int followY;
+    int heading;
+    size_t moves;
+    std::vector<SearchMark> searchMarks;
+    const std::atomic<bool>* cancelFlag;
+    // Cells expanded and the largest frontier (the wall follower's route)
+    // this search, for the profiler
+    uint64_t expanded;
+    size_t peakFrontier;
+
+    // Validate the endpoints and set up the selected algorithm
+    bool startSearch(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal);
+    // Stop searching and build the solution if the goal was reached
+    void finishSearch(const MazeGrid& maze);
+    // Per-algorithm state machines: each step returns false once the search
+    // is over, with found set if it reached the goal
+    void startBfs(const MazeGrid& maze);
+    bool stepBfs(const MazeGrid& maze);
+    void startBidirectional(const MazeGrid& maze);
+    bool stepBidirectional(const MazeGrid& maze);
+    void startAStar(const MazeGrid& maze);
+    bool stepAStar(const MazeGrid& maze);
+    void startDeadEndFilling(const MazeGrid& maze);
+    bool stepDeadEndFilling(const MazeGrid& maze);
+    void startWallFollower(const MazeGrid& maze);
+    bool stepWallFollower(const MazeGrid& maze);
+
+    // Queue the start cell for BFS; cells already marked in parentDir are
+    // never entered
+    void seedBfs(const MazeGrid& maze);
+    // Join the two bidirectional trees at cell
+    bool meetAt(const MazeGrid& maze, uint32_t cell);
+    uint32_t heuristic(const MazeGrid& maze, uint32_t cell) const;
+    bool isStart(uint32_t cell) const { return cell == startCells[0] || cell == startCells[1]; }
+    bool isGoal(uint32_t cell) const { return cell == goalCells[0] || cell == goalCells[1]; }
+    bool isCancelled() const {
+        return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+    }
+    void notePeak(size_t frontierSize) {
+        if (frontierSize > peakFrontier) peakFrontier = frontierSize;
+    }
+    // Record the cell's slot, and the passage it was entered through
+    // (dir from its parent, -1 for none), as changed
+    void mark(const MazeGrid& maze, uint32_t cell, int dir, CellState state);
+    // Append cell and its parent chain back to (and including) its root
+    void traceBack(const MazeGrid& maze, const std::vector<uint8_t>& parents, uint32_t cell);
+    // The cells an open slot belongs to or borders (see startCells)
+    static void slotToCells(const MazeGrid& maze, int x, int y, uint32_t cells[2]);
+    void buildSolution(const MazeGrid& maze, std::pair<int, int> start, std::pair<int, int> goal);
 };
@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+// Paces an incremental task (MazeGenerator::step and the like) across frames.
+//
+// Each run() call performs as many steps as are owed at the configured
+// steps-per-second rate, but never spends more than the frame budget, so an
+// animation has the same speed at any frame rate and never stalls a frame
+// however large the maze. A rate of 0 means as many steps as fit the budget.
+class MazeStepScheduler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit MazeStepScheduler(double stepsPerSecond = 0, double frameBudget = 0.008)
+        : rate(stepsPerSecond), budget(frameBudget), owed(0), last(Clock::now()) {}
+
+    void setStepsPerSecond(double stepsPerSecond) { rate = std::max(0.0, stepsPerSecond); }
+    double getStepsPerSecond() const { return rate; }
+    // Wall-clock seconds one run() may take
+    void setFrameBudget(double seconds) { budget = std::max(0.0, seconds); }
+    double getFrameBudget() const { return budget; }
+
+    // Start counting owed steps from now, e.g. when a new run begins
+    void restart() {
+        owed = 0;
+        last = Clock::now();
+    }
+
+    // Call step() until it returns false, the owed steps are done or the
+    // budget is spent. Returns the number of steps taken.
+    template <typename Step>
+    size_t run(Step step) {
+        Clock::time_point now = Clock::now();
+        size_t allowed = std::numeric_limits<size_t>::max();
+        if (rate > 0) {
+            // Carry fractional steps between frames, but drop the backlog
+            // of a long stall instead of catching up in one burst
+            owed += rate * std::chrono::duration<double>(now - last).count();
+            owed = std::min(owed, rate * kMaxLag + 1);
+            allowed = static_cast<size_t>(owed);
+        }
+        last = now;
+
+        Clock::time_point deadline =
+            now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(budget));
+        size_t steps = 0;
+        while (steps < allowed) {
+            steps++;
+            if (!step()) {
+                owed = 0;
+                return steps;
+            }
+            // Reading the clock costs more than a typical step
+            if ((steps & (kClockInterval - 1)) == 0 && Clock::now() >= deadline) break;
+        }
+        if (rate > 0) owed -= static_cast<double>(steps);
+        return steps;
+    }
+
+private:
+    static constexpr size_t kClockInterval = 64;
+    static constexpr double kMaxLag = 0.1;
+
+    double rate;
+    double budget;
+    double owed;
+    Clock::time_point last;
+};
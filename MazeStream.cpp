@@ -0,0 +1,145 @@
+#include "MazeStream.h"
+#include <algorithm>
+#include <stdexcept>
+
+const uint32_t MazeStream::kNoSet;
+
+MazeStream::MazeStream(int width, uint64_t seed)
+    : width(0), wordsPerRow(0), openings(true), rowCount(0), finished(false),
+      coinBits(0), coinCount(0) {
+    reset(width, seed);
+}
+
+void MazeStream::reset(uint64_t seed) {
+    rng.setSeed(seed);
+    coinBits = 0;
+    coinCount = 0;
+    rowCount = 0;
+    finished = false;
+    std::fill(label.begin(), label.end(), kNoSet);
+}
+
+void MazeStream::reset(int width, uint64_t seed) {
+    // Memory is linear in the width, so only the slot index has to fit an int
+    if (width <= 0 || width > (1 << 30) - 1) {
+        throw std::invalid_argument("Invalid maze width");
+    }
+    this->width = width;
+    wordsPerRow = (getSlotWidth() + MazeGrid::kWordBits - 1) / MazeGrid::kWordBits;
+    label.resize(width);
+    parent.resize(width);
+    remap.assign(width, kNoSet);
+    remaining.resize(width);
+    hasDown.resize(width);
+    cellRow.resize(wordsPerRow);
+    wallRow.resize(wordsPerRow);
+    reset(seed);
+}
+
+void MazeStream::generate(int64_t height, const RowCallback& emit) {
+    if (height <= 0) {
+        throw std::invalid_argument("Invalid maze height");
+    }
+    if (rowCount > 0 || finished) {
+        reset(rng.getSeed());
+    }
+    for (int64_t y = 0; y < height; y++) {
+        nextRow(emit, y == height - 1);
+    }
+}
+
+void MazeStream::nextRow(const RowCallback& emit, bool last) {
+    if (finished) {
+        throw std::logic_error("Maze stream already finished");
+    }
+    if (rowCount == 0) {
+        clearRow(wallRow);
+        if (openings) carveBit(wallRow, 1);
+        emit(0, wallRow.data());
+    }
+    assignLabels();
+
+    // Join neighbouring cells of different sets at random (always on the
+    // last row, which must end up as a single set)
+    clearRow(cellRow);
+    carveBit(cellRow, 1);
+    for (int x = 0; x + 1 < width; x++) {
+        carveBit(cellRow, 2 * x + 3);
+        uint32_t a = findSet(label[x]);
+        uint32_t b = findSet(label[x + 1]);
+        if (a != b && (last || coin())) {
+            carveBit(cellRow, 2 * x + 2);
+            parent[b] = a;
+        }
+    }
+    for (int x = 0; x < width; x++) {
+        label[x] = findSet(label[x]);
+    }
+
+    clearRow(wallRow);
+    if (last) {
+        if (openings) carveBit(wallRow, 2 * width - 1);
+        finished = true;
+    } else {
+        // Every set continues downwards through at least one cell, so no
+        // region is cut off; the others start fresh sets on the next row
+        for (int x = 0; x < width; x++) {
+            remaining[label[x]]++;
+            hasDown[label[x]] = 0;
+        }
+        for (int x = 0; x < width; x++) {
+            uint32_t set = label[x];
+            bool forced = --remaining[set] == 0 && !hasDown[set];
+            if (forced || coin()) {
+                carveBit(wallRow, 2 * x + 1);
+                hasDown[set] = 1;
+            } else {
+                label[x] = kNoSet;
+            }
+        }
+    }
+
+    int64_t slotY = 2 * rowCount + 1;
+    rowCount++;
+    emit(slotY, cellRow.data());
+    emit(slotY + 1, wallRow.data());
+}
+
+//--------------------------------------------------------------
+void MazeStream::assignLabels() {
+    // Compact the labels carried down from the previous row to [0, k) and
+    // give every other cell a fresh set, so labels always index width-sized
+    // arrays
+    uint32_t next = 0;
+    for (int x = 0; x < width; x++) {
+        if (label[x] == kNoSet) continue;
+        uint32_t& mapped = remap[label[x]];
+        if (mapped == kNoSet) {
+            parent[next] = label[x];  // remember which entries to clear
+            mapped = next++;
+        }
+        label[x] = mapped;
+    }
+    for (uint32_t i = 0; i < next; i++) {
+        remap[parent[i]] = kNoSet;
+    }
+    for (int x = 0; x < width; x++) {
+        if (label[x] == kNoSet) label[x] = next++;
+    }
+    for (uint32_t i = 0; i < next; i++) {
+        parent[i] = i;
+        remaining[i] = 0;
+    }
+}
+
+uint32_t MazeStream::findSet(uint32_t set) {
+    while (parent[set] != set) {
+        parent[set] = parent[parent[set]];
+        set = parent[set];
+    }
+    return set;
+}
+
+void MazeStream::clearRow(std::vector<Word>& row) {
+    std::fill(row.begin(), row.end(), ~Word(0));
+}
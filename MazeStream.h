@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "MazeGrid.h"
+#include "MazeRandom.h"
+
+// Row-by-row maze generator (Eller's algorithm) with O(width) memory.
+//
+// Only the set labels of the current cell row are kept, so mazes of any
+// height can be written straight to a file or socket, or produced lazily
+// as a viewer scrolls. Rows are emitted in MazeGrid's packed slot layout
+// (1 = wall, padding bits set), so they can be copied into a grid as-is.
+// The output is a perfect maze and depends only on (width, seed).
+class MazeStream {
+public:
+    typedef MazeGrid::Word Word;
+    // Receives the slot row index and getWordsPerRow() words of that row.
+    // The pointer is only valid during the call.
+    typedef std::function<void(int64_t slotY, const Word* row)> RowCallback;
+
+    explicit MazeStream(int width = 1, uint64_t seed = 0);
+
+    // Restart at the top of a new maze
+    void reset(uint64_t seed);
+    void reset(int width, uint64_t seed);
+
+    // Open the entrance in the top border and the exit in the bottom border
+    // (on by default; off when the rows are carved into a larger grid)
+    void setOpenings(bool open) { openings = open; }
+
+    int getWidth() const { return width; }
+    int getSlotWidth() const { return 2 * width + 1; }
+    size_t getWordsPerRow() const { return wordsPerRow; }
+    // Cell rows emitted so far
+    int64_t getRowCount() const { return rowCount; }
+    bool isFinished() const { return finished; }
+
+    // Emit the next cell row and the wall row below it (preceded by the top
+    // border on the first call). With last = true every remaining set is
+    // joined and the bottom border closes the maze.
+    void nextRow(const RowCallback& emit, bool last = false);
+    // Emit a whole maze of the given height, 2 * height + 1 slot rows
+    void generate(int64_t height, const RowCallback& emit);
+
+private:
+    static const uint32_t kNoSet = 0xFFFFFFFFu;
+
+    int width;
+    size_t wordsPerRow;
+    bool openings;
+    int64_t rowCount;
+    bool finished;
+    MazeRandom rng;
+    uint64_t coinBits;
+    int coinCount;
+
+    // Set label per cell of the current row, kNoSet for cells not yet joined
+    // to the row above
+    std::vector<uint32_t> label;
+    // Per-row union-find over labels, remapping and vertical-carve bookkeeping
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> remap;
+    std::vector<uint32_t> remaining;
+    std::vector<uint8_t> hasDown;
+    std::vector<Word> cellRow;
+    std::vector<Word> wallRow;
+
+    void assignLabels();
+    uint32_t findSet(uint32_t set);
+    void clearRow(std::vector<Word>& row);
+    static void carveBit(std::vector<Word>& row, int x) {
+        row[x / MazeGrid::kWordBits] &= ~(Word(1) << (x % MazeGrid::kWordBits));
+    }
+    // One fair random bit, drawn 64 at a time from the engine
+    bool coin() {
+        if (coinCount == 0) {
+            coinBits = rng.next();
+            coinCount = 64;
+        }
+        coinCount--;
+        bool bit = coinBits & 1;
+        coinBits >>= 1;
+        return bit;
+    }
+};
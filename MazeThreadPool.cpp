@@ -0,0 +1,140 @@
+#include "MazeThreadPool.h"
+#include <algorithm>
+
+namespace {
+thread_local bool insidePool = false;
+}
+
+MazeThreadPool::MazeThreadPool(unsigned threadCount)
+    : body(nullptr), epoch(0), busyWorkers(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        ranges.push_back(std::make_unique<Range>());
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back(&MazeThreadPool::workerLoop, this, i);
+    }
+}
+
+MazeThreadPool::~MazeThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+MazeThreadPool& MazeThreadPool::shared() {
+    static MazeThreadPool pool;
+    return pool;
+}
+
+void MazeThreadPool::parallelFor(size_t count,
+                                 const std::function<void(size_t index, unsigned worker)>& body) {
+    if (count == 0) return;
+    if (insidePool || threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) {
+            body(i, 0);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(runLock);
+    unsigned workers = getThreadCount();
+    for (unsigned w = 0; w < workers; w++) {
+        std::lock_guard<std::mutex> guard(ranges[w]->lock);
+        ranges[w]->begin = count * w / workers;
+        ranges[w]->end = count * (w + 1) / workers;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        this->body = &body;
+        failure = nullptr;
+        busyWorkers = workers;
+        epoch++;
+    }
+    wakeWorkers.notify_all();
+
+    runWorker(0);
+
+    std::unique_lock<std::mutex> lock(stateLock);
+    workersDone.wait(lock, [this] { return busyWorkers == 0; });
+    this->body = nullptr;
+    if (failure) {
+        std::exception_ptr error = failure;
+        failure = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+//--------------------------------------------------------------
+void MazeThreadPool::workerLoop(unsigned worker) {
+    insidePool = true;
+    size_t seenEpoch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateLock);
+            wakeWorkers.wait(lock, [&] { return stopping || epoch != seenEpoch; });
+            if (stopping) return;
+            seenEpoch = epoch;
+        }
+        runWorker(worker);
+    }
+}
+
+void MazeThreadPool::runWorker(unsigned worker) {
+    bool wasInside = insidePool;
+    insidePool = true;
+    size_t index;
+    while (takeOwn(worker, index) || (steal(worker) && takeOwn(worker, index))) {
+        try {
+            (*body)(index, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (!failure) failure = std::current_exception();
+        }
+    }
+    insidePool = wasInside;
+
+    std::lock_guard<std::mutex> guard(stateLock);
+    if (--busyWorkers == 0) {
+        workersDone.notify_all();
+    }
+}
+
+bool MazeThreadPool::takeOwn(unsigned worker, size_t& index) {
+    Range& range = *ranges[worker];
+    std::lock_guard<std::mutex> guard(range.lock);
+    if (range.begin >= range.end) return false;
+    index = range.begin++;
+    return true;
+}
+
+bool MazeThreadPool::steal(unsigned worker) {
+    // Scan victims starting after ourselves so thieves spread out
+    unsigned workers = getThreadCount();
+    for (unsigned offset = 1; offset < workers; offset++) {
+        Range& victim = *ranges[(worker + offset) % workers];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            size_t remaining = victim.end - std::min(victim.begin, victim.end);
+            if (remaining == 0) continue;
+            end = victim.end;
+            begin = victim.end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+        Range& own = *ranges[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads running index-space loops with work stealing.
+//
+// parallelFor() splits [0, count) into one contiguous range per worker.
+// Each worker takes indices from the front of its own range; a worker that
+// runs dry scans the other ranges round-robin, starting with the next
+// worker's, and steals the back half of the first non-empty one. No
+// per-item allocation happens, and the worker id passed to the body lets
+// callers keep per-thread scratch buffers.
+class MazeThreadPool {
+public:
+    // threads == 0 uses std::thread::hardware_concurrency()
+    explicit MazeThreadPool(unsigned threads = 0);
+    ~MazeThreadPool();
+    MazeThreadPool(const MazeThreadPool&) = delete;
+    MazeThreadPool& operator=(const MazeThreadPool&) = delete;
+
+    // Number of workers, including the calling thread
+    unsigned getThreadCount() const { return static_cast<unsigned>(ranges.size()); }
+
+    // Run body(index, worker) for every index and block until all are done.
+    // The calling thread takes part as worker 0. The first exception thrown
+    // by a body is rethrown here. Calls from inside a body run serially.
+    void parallelFor(size_t count, const std::function<void(size_t index, unsigned worker)>& body);
+
+    // Process-wide pool sized to the machine
+    static MazeThreadPool& shared();
+
+private:
+    struct alignas(64) Range {
+        std::mutex lock;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::unique_ptr<Range>> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex runLock;      // one parallelFor at a time
+    std::mutex stateLock;
+    std::condition_variable wakeWorkers;
+    std::condition_variable workersDone;
+    const std::function<void(size_t, unsigned)>* body;
+    size_t epoch;
+    unsigned busyWorkers;
+    bool stopping;
+    std::exception_ptr failure;
+
+    void workerLoop(unsigned worker);
+    void runWorker(unsigned worker);
+    bool takeOwn(unsigned worker, size_t& index);
+    bool steal(unsigned worker);
+};
@@ -0,0 +1,248 @@
+#include "MazeGenerator.h"
+#include "MazeMesh.h"
+#include "MazeRaster.h"
+#include "MazeSolver.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <sys/resource.h>
+#include <vector>
+
+// Microbenchmarks of generation, solving and geometry construction, for
+// comparing builds over time. Besides the time, every benchmark reports:
+//   ns/cell     time per maze cell
+//   bytes/iter  heap bytes allocated per iteration (allocs/iter: calls)
+//   peak_rss_kB high-water resident set size while the benchmark ran
+//
+// Run with --benchmark_format=json (or --benchmark_out=FILE) to keep results.
+
+namespace {
+
+std::atomic<size_t> allocatedBytes(0);
+std::atomic<size_t> allocationCount(0);
+
+const int kSizes[] = {10, 64, 256, 1024, 4096};
+const uint64_t kSeed = 12345;
+
+// Discards output while still formatting it, for the raster benchmark
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Reset the kernel's peak RSS counter so each benchmark sees its own peak.
+// Without /proc the peak is process-wide and only ever grows.
+void resetPeakRss() {
+    if (FILE* file = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", file);
+        std::fclose(file);
+    }
+}
+
+long peakRssKb() {
+    if (FILE* file = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long kb = -1;
+        while (std::fgets(line, sizeof(line), file)) {
+            if (std::strncmp(line, "VmHWM:", 6) == 0) kb = std::strtol(line + 6, nullptr, 10);
+        }
+        std::fclose(file);
+        if (kb >= 0) return kb;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Brackets the timed loop of one benchmark and reports the counters
+class Meter {
+public:
+    explicit Meter(benchmark::State& state) : state(state) { resetPeakRss(); }
+
+    void start() {
+        startTime = std::chrono::steady_clock::now();
+        startBytes = allocatedBytes.load(std::memory_order_relaxed);
+        startCount = allocationCount.load(std::memory_order_relaxed);
+    }
+
+    void stop(size_t cells) {
+        using benchmark::Counter;
+        double bytes = static_cast<double>(allocatedBytes.load(std::memory_order_relaxed) -
+                                           startBytes);
+        double count = static_cast<double>(allocationCount.load(std::memory_order_relaxed) -
+                                           startCount);
+        double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - startTime).count();
+        state.counters["ns/cell"] = Counter(ns / (static_cast<double>(state.iterations()) * cells));
+        state.counters["bytes/iter"] = Counter(bytes, Counter::kAvgIterations, Counter::kIs1024);
+        state.counters["allocs/iter"] = Counter(count, Counter::kAvgIterations);
+        state.counters["peak_rss_kB"] = Counter(static_cast<double>(peakRssKb()));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cells));
+    }
+
+private:
+    benchmark::State& state;
+    std::chrono::steady_clock::time_point startTime;
+    size_t startBytes = 0;
+    size_t startCount = 0;
+};
+
+MazeGrid makeMaze(int size) {
+    MazeGenerator generator(size, size, MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER);
+    MazeGrid maze;
+    generator.generate(maze, kSeed);
+    return maze;
+}
+
+//--------------------------------------------------------------
+void BM_Generate(benchmark::State& state, MazeGenerator::Algorithm algorithm) {
+    int size = static_cast<int>(state.range(0));
+    MazeGenerator generator(size, size, algorithm);
+    MazeGrid maze;
+    uint64_t seed = kSeed;
+    Meter meter(state);
+    meter.start();
+    for (auto _ : state) {
+        generator.generate(maze, seed++);
+        benchmark::DoNotOptimize(maze.row(0));
+    }
+    meter.stop(maze.getCellCount());
+}
+
+void BM_Solve(benchmark::State& state, MazeSolver::Algorithm algorithm) {
+    int size = static_cast<int>(state.range(0));
+    MazeGrid maze = makeMaze(size);
+    MazeSolver solver(algorithm);
+    Meter meter(state);
+    meter.start();
+    for (auto _ : state) {
+        solver.solve(maze);
+        benchmark::DoNotOptimize(solver.getSolution().data());
+    }
+    meter.stop(maze.getCellCount());
+}
+
+// Wall geometry in the renderer's 64 x 64 slot chunks
+void BM_WallMesh(benchmark::State& state) {
+    const int kChunkSlots = 64;
+    MazeGrid maze = makeMaze(static_cast<int>(state.range(0)));
+    MazeMesh mesh;
+    Meter meter(state);
+    meter.start();
+    for (auto _ : state) {
+        for (int top = 0; top < maze.getSlotHeight(); top += kChunkSlots) {
+            for (int left = 0; left < maze.getSlotWidth(); left += kChunkSlots) {
+                mesh.buildWalls(maze, 10.0f, 20.0f, left, top,
+                                std::min(left + kChunkSlots, maze.getSlotWidth()),
+                                std::min(top + kChunkSlots, maze.getSlotHeight()));
+                benchmark::DoNotOptimize(mesh.vertices.data());
+            }
+        }
+    }
+    meter.stop(maze.getCellCount());
+}
+
+void BM_SolutionTube(benchmark::State& state) {
+    MazeGrid maze = makeMaze(static_cast<int>(state.range(0)));
+    MazeSolver solver;
+    solver.solve(maze);
+    MazeMesh mesh;
+    Meter meter(state);
+    meter.start();
+    for (auto _ : state) {
+        mesh.buildTube(solver.getSolution(), 10.0f, 2.0f, 5.0f);
+        benchmark::DoNotOptimize(mesh.vertices.data());
+    }
+    meter.stop(maze.getCellCount());
+}
+
+// 2D image, one pixel per slot with the solution shaded, as the viewer's
+// slot texture; written to a discarding stream
+void BM_Raster2D(benchmark::State& state) {
+    MazeGrid maze = makeMaze(static_cast<int>(state.range(0)));
+    MazeSolver solver;
+    solver.solve(maze);
+    MazeRaster raster;
+    raster.setSlotPixels(1);
+    NullBuffer buffer;
+    std::ostream out(&buffer);
+    Meter meter(state);
+    meter.start();
+    for (auto _ : state) {
+        raster.write(out, MazeRaster::Format::PGM, maze, solver.getSolution());
+    }
+    meter.stop(maze.getCellCount());
+}
+
+void registerAll() {
+    // Named as on the mazegen command line, to keep filters simple
+    const std::pair<const char*, MazeGenerator::Algorithm> generators[] = {
+        {"backtracker", MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER},
+        {"prims", MazeGenerator::Algorithm::PRIMS},
+        {"kruskals", MazeGenerator::Algorithm::KRUSKALS},
+        {"aldous-broder", MazeGenerator::Algorithm::ALDOUS_BRODER},
+        {"wilson", MazeGenerator::Algorithm::WILSON},
+        {"ellers", MazeGenerator::Algorithm::ELLERS}};
+    const std::pair<const char*, MazeSolver::Algorithm> solvers[] = {
+        {"bfs", MazeSolver::Algorithm::BFS},
+        {"bidirectional", MazeSolver::Algorithm::BIDIRECTIONAL_BFS},
+        {"astar", MazeSolver::Algorithm::A_STAR},
+        {"dead-end", MazeSolver::Algorithm::DEAD_END_FILLING},
+        {"wall-follower", MazeSolver::Algorithm::WALL_FOLLOWER}};
+
+    std::vector<benchmark::internal::Benchmark*> all;
+    for (const auto& generator : generators) {
+        std::string name = std::string("Generate/") + generator.first;
+        all.push_back(benchmark::RegisterBenchmark(name.c_str(), BM_Generate, generator.second));
+    }
+    for (const auto& solver : solvers) {
+        std::string name = std::string("Solve/") + solver.first;
+        all.push_back(benchmark::RegisterBenchmark(name.c_str(), BM_Solve, solver.second));
+    }
+    all.push_back(benchmark::RegisterBenchmark("Mesh/Walls3D", BM_WallMesh));
+    all.push_back(benchmark::RegisterBenchmark("Mesh/SolutionTube3D", BM_SolutionTube));
+    all.push_back(benchmark::RegisterBenchmark("Raster/2D", BM_Raster2D));
+    for (auto* bench : all) {
+        for (int size : kSizes) bench->Arg(size);
+        bench->Unit(benchmark::kMicrosecond);
+    }
+}
+
+}  // namespace
+
+// Count every heap allocation for bytes/iter
+void* operator new(size_t size) {
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    registerAll();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
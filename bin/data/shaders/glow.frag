@@ -5,18 +5,28 @@ precision mediump float;
 #endif
 
 uniform vec3 glowColor;
+// Solid colour of the tube, which has no per-vertex colours
+uniform vec3 baseColor;
 uniform float glowIntensity;
 uniform float time;
+uniform float emissive;
+
+// Point lights sampled along the solution, in model space
+#define MAX_PATH_LIGHTS 64
+uniform vec3 pathLights[MAX_PATH_LIGHTS];
+uniform int pathLightCount;
+uniform float pathLightRadius;
+uniform vec3 pathLightColor;
 
-in vec4 vertexColor;
 in vec3 vertexNormal;
 in vec4 vertexPosition;
+in vec3 modelPosition;
+in vec3 modelNormal;
 
 out vec4 outputColor;
 
 void main() {
-    // Base color with simple rim lighting
-    vec3 baseColor = vertexColor.rgb;
+    // Simple rim lighting
     vec3 viewDir = normalize(-vertexPosition.xyz);
     float rimFactor = 1.0 - max(dot(vertexNormal, viewDir), 0.0);
     rimFactor = pow(rimFactor, 3.0);
@@ -24,8 +34,20 @@ void main() {
     // Simple pulsing effect
     float pulse = 0.8 + 0.2 * sin(time * 2.0);
     
+    // Path lights: smooth falloff to zero at pathLightRadius
+    vec3 normal = normalize(modelNormal);
+    vec3 pathLight = vec3(0.0);
+    for (int i = 0; i < pathLightCount; i++) {
+        vec3 toLight = pathLights[i] - modelPosition;
+        float dist = length(toLight);
+        float falloff = clamp(1.0 - dist / pathLightRadius, 0.0, 1.0);
+        float diffuse = max(dot(normal, toLight / max(dist, 0.0001)), 0.0);
+        pathLight += pathLightColor * falloff * falloff * diffuse;
+    }
+    
     // Combine effects
     vec3 finalColor = mix(baseColor, glowColor, rimFactor * pulse * glowIntensity);
+    finalColor += baseColor * emissive + pathLight;
     
     // Output with full opacity
     outputColor = vec4(finalColor, 1.0);
@@ -7,14 +7,14 @@ uniform mat4 textureMatrix;
 uniform mat4 normalMatrix;
 
 in vec4 position;
-in vec4 color;
 in vec4 normal;
 in vec2 texcoord;
 
-out vec4 vertexColor;
 out vec3 vertexNormal;
 out vec4 vertexPosition;
 out vec2 texCoordVarying;
+out vec3 modelPosition;
+out vec3 modelNormal;
 
 void main() {
     // Transform vertex position to view space
@@ -23,8 +23,11 @@ void main() {
     // Transform normal to view space
     vertexNormal = normalize((normalMatrix * normal).xyz);
     
-    // Pass through color and texture coordinates
-    vertexColor = color;
+    // Model-space position and normal for the path lights
+    modelPosition = position.xyz;
+    modelNormal = normal.xyz;
+    
+    // Pass through texture coordinates
     texCoordVarying = (textureMatrix * vec4(texcoord.x, texcoord.y, 0, 1)).xy;
     
     // Output final position
@@ -0,0 +1,381 @@
+#include "MazeBatch.h"
+#include "MazeCache.h"
+#include "MazeFile.h"
+#include "MazeProfiler.h"
+#include "MazeRaster.h"
+#include "MazeStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Headless batch tool: generate (and optionally solve) mazes and write
+// them to disk without openFrameworks or a GL context.
+
+namespace {
+
+struct Options {
+    int width = 20;
+    int64_t height = 20;
+    int count = 1;
+    MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER;
+    bool solve = true;
+    MazeSolver::Algorithm solver = MazeSolver::Algorithm::BFS;
+    std::string output = ".";
+    std::string format = "pbm";
+    uint64_t seed = MazeRandom::randomSeed();
+    unsigned threads = 0;
+    int tileSize = 0;
+    std::string stream;
+    std::string load;
+    int pixels = 4;
+    std::string cache;
+    std::string trace;
+};
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  -W, --width N        maze width in cells (default 20)\n"
+        "  -H, --height N       maze height in cells (default 20)\n"
+        "  -n, --count N        number of mazes to generate (default 1)\n"
+        "  -a, --algorithm A    backtracker | prims | kruskals | aldous-broder | wilson\n"
+        "                       | ellers\n"
+        "  -s, --solver S       bfs | bidirectional | astar | dead-end | wall-follower | none\n"
+        "  -S, --seed N         seed of the first maze, maze i uses N + i (default random)\n"
+        "  -j, --threads N      worker threads (default: all cores)\n"
+        "  -t, --tile N         carve each maze as parallel N x N cell tiles\n"
+        "  -o, --output DIR     output directory (default .)\n"
+        "  -f, --format F       pbm | pgm | png | txt | maze | none (default pbm)\n"
+        "  -p, --pixels N       pixels per slot in pgm / png images, with the solution\n"
+        "                       shaded (default 4)\n"
+        "  -r, --stream FILE    write one Eller's maze row by row to FILE ('-' for\n"
+        "                       stdout) in O(width) memory, as pbm or txt; height\n"
+        "                       is unbounded\n"
+        "  -c, --cache DIR      reuse mazes kept in DIR from earlier runs and add new ones\n"
+        "  -l, --load FILE      map a .maze file, check it, solve it with --solver and\n"
+        "                       write it to --output in --format\n"
+        "  -T, --trace FILE     record generate / solve / raster timings of the batch\n"
+        "                       as Chrome trace JSON (chrome://tracing, Perfetto)\n"
+        "      --help           show this message\n",
+        program);
+}
+
+bool parseAlgorithm(const std::string& name, MazeGenerator::Algorithm& algorithm) {
+    if (name == "backtracker") algorithm = MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER;
+    else if (name == "prims") algorithm = MazeGenerator::Algorithm::PRIMS;
+    else if (name == "kruskals") algorithm = MazeGenerator::Algorithm::KRUSKALS;
+    else if (name == "aldous-broder") algorithm = MazeGenerator::Algorithm::ALDOUS_BRODER;
+    else if (name == "wilson") algorithm = MazeGenerator::Algorithm::WILSON;
+    else if (name == "ellers") algorithm = MazeGenerator::Algorithm::ELLERS;
+    else return false;
+    return true;
+}
+
+bool parseSolver(const std::string& name, Options& options) {
+    options.solve = true;
+    if (name == "bfs") options.solver = MazeSolver::Algorithm::BFS;
+    else if (name == "bidirectional") options.solver = MazeSolver::Algorithm::BIDIRECTIONAL_BFS;
+    else if (name == "astar") options.solver = MazeSolver::Algorithm::A_STAR;
+    else if (name == "dead-end") options.solver = MazeSolver::Algorithm::DEAD_END_FILLING;
+    else if (name == "wall-follower") options.solver = MazeSolver::Algorithm::WALL_FOLLOWER;
+    else if (name == "none") options.solve = false;
+    else return false;
+    return true;
+}
+
+bool parseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "-W" || arg == "--width") {
+            options.width = std::atoi(value.c_str());
+        } else if (arg == "-H" || arg == "--height") {
+            options.height = std::strtoll(value.c_str(), nullptr, 10);
+        } else if (arg == "-n" || arg == "--count") {
+            options.count = std::atoi(value.c_str());
+        } else if (arg == "-a" || arg == "--algorithm") {
+            if (!parseAlgorithm(value, options.algorithm)) {
+                std::fprintf(stderr, "Unknown algorithm: %s\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "-s" || arg == "--solver") {
+            if (!parseSolver(value, options)) {
+                std::fprintf(stderr, "Unknown solver: %s\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "-S" || arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "-j" || arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "-t" || arg == "--tile") {
+            options.tileSize = std::atoi(value.c_str());
+        } else if (arg == "-r" || arg == "--stream") {
+            options.stream = value;
+        } else if (arg == "-p" || arg == "--pixels") {
+            options.pixels = std::atoi(value.c_str());
+        } else if (arg == "-c" || arg == "--cache") {
+            options.cache = value;
+        } else if (arg == "-T" || arg == "--trace") {
+            options.trace = value;
+        } else if (arg == "-l" || arg == "--load") {
+            options.load = value;
+        } else if (arg == "-o" || arg == "--output") {
+            options.output = value;
+        } else if (arg == "-f" || arg == "--format") {
+            if (value != "pbm" && value != "pgm" && value != "png" && value != "txt" &&
+                value != "maze" && value != "none") {
+                std::fprintf(stderr, "Unknown format: %s\n", value.c_str());
+                return false;
+            }
+            options.format = value;
+        } else {
+            std::fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    if (!options.stream.empty() && options.format != "pbm" && options.format != "txt") {
+        std::fprintf(stderr, "--stream writes pbm or txt only, not %s\n", options.format.c_str());
+        return false;
+    }
+    if (options.format == "png" && !MazeRaster::isPngSupported()) {
+        std::fprintf(stderr, "PNG output needs zlib, which this build lacks\n");
+        return false;
+    }
+    return options.count >= 0 && options.pixels >= 1;
+}
+
+// One PBM raster row (MSB first, 1 = black) from a packed grid row
+void packPbmRow(const MazeGrid::Word* words, int slotWidth, std::string& row) {
+    row.assign((slotWidth + 7) / 8, '\0');
+    for (int x = 0; x < slotWidth; x++) {
+        if ((words[x / MazeGrid::kWordBits] >> (x % MazeGrid::kWordBits)) & 1) {
+            row[x / 8] |= static_cast<char>(0x80 >> (x % 8));
+        }
+    }
+}
+
+// Binary PBM, one pixel per slot, walls black
+bool writePbm(const std::string& path, const MazeGrid& maze) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out << "P4\n" << maze.getSlotWidth() << " " << maze.getSlotHeight() << "\n";
+
+    std::string row;
+    for (int y = 0; y < maze.getSlotHeight(); y++) {
+        packPbmRow(maze.row(y), maze.getSlotWidth(), row);
+        out.write(row.data(), row.size());
+    }
+    return static_cast<bool>(out);
+}
+
+// ASCII art: '#' wall, ' ' open, '.' solution
+bool writeText(const std::string& path, const MazeGrid& maze,
+               const std::vector<std::pair<int, int>>& solution) {
+    std::ofstream out(path);
+    if (!out) return false;
+    size_t stride = maze.getSlotWidth() + 1;
+    std::string text(stride * maze.getSlotHeight(), ' ');
+    for (int y = 0; y < maze.getSlotHeight(); y++) {
+        for (int x = 0; x < maze.getSlotWidth(); x++) {
+            if (maze.isWall(x, y)) text[y * stride + x] = '#';
+        }
+        text[y * stride + stride - 1] = '\n';
+    }
+    for (const auto& slot : solution) {
+        text[slot.second * stride + slot.first] = '.';
+    }
+    out << text;
+    return static_cast<bool>(out);
+}
+
+// Write maze to path in any of the grid formats
+bool writeMaze(const Options& options, const std::string& path, const MazeGrid& maze,
+               const std::vector<std::pair<int, int>>& solution, MazeThreadPool& pool,
+               uint32_t algorithm, uint64_t seed) {
+    if (options.format == "pbm") return writePbm(path, maze);
+    if (options.format == "txt") return writeText(path, maze, solution);
+    if (options.format == "maze") return MazeFile::save(path, maze, algorithm, seed, solution);
+    // In a batch of several mazes the pool is already busy and the bands of
+    // each image are rasterised serially
+    MazeRaster raster(pool);
+    raster.setSlotPixels(options.pixels);
+    return raster.write(path, options.format == "png" ? MazeRaster::Format::PNG : MazeRaster::Format::PGM,
+                        maze, solution);
+}
+
+// Stream an Eller's maze to a file or stdout without ever holding the grid
+bool writeStream(const Options& options) {
+    std::ofstream file;
+    if (options.stream != "-") {
+        file.open(options.stream, std::ios::binary);
+        if (!file) return false;
+    }
+    std::ostream& out = options.stream == "-" ? std::cout : file;
+
+    MazeStream stream(options.width, options.seed);
+    bool pbm = options.format != "txt";
+    if (pbm) {
+        out << "P4\n" << stream.getSlotWidth() << " " << 2 * options.height + 1 << "\n";
+    }
+    std::string row;
+    stream.generate(options.height, [&](int64_t, const MazeGrid::Word* words) {
+        if (pbm) {
+            packPbmRow(words, stream.getSlotWidth(), row);
+        } else {
+            row.assign(stream.getSlotWidth() + 1, '\n');
+            for (int x = 0; x < stream.getSlotWidth(); x++) {
+                bool wall = (words[x / MazeGrid::kWordBits] >> (x % MazeGrid::kWordBits)) & 1;
+                row[x] = wall ? '#' : ' ';
+            }
+        }
+        out.write(row.data(), row.size());
+    });
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+// Map a saved maze, solve it in place and optionally write it back out
+bool loadMaze(const Options& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    MazeFile file;
+    file.open(options.load);
+    const MazeGrid& maze = file.getGrid();
+    double openMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (!file.verify()) {
+        std::fprintf(stderr, "Checksum mismatch in %s\n", options.load.c_str());
+        return false;
+    }
+
+    std::vector<std::pair<int, int>> solution;
+    double solveMs = 0;
+    if (options.solve) {
+        MazeSolver solver(options.solver);
+        t0 = std::chrono::steady_clock::now();
+        solver.solve(maze);
+        solveMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        solution = solver.getSolution();
+    } else if (!file.readSolution(solution)) {
+        std::fprintf(stderr, "Stored solution of %s leaves the maze\n", options.load.c_str());
+        return false;
+    }
+
+    const MazeFile::Header& header = file.getHeader();
+    std::printf("%s: %dx%d, %s, seed %llu, %zu solution slots: open %.3f ms, solve %.3f ms\n",
+                options.load.c_str(), maze.getWidth(), maze.getHeight(),
+                header.algorithm == MazeFile::kNoAlgorithm
+                    ? "unknown algorithm"
+                    : MazeGenerator::getAlgorithmName(
+                          static_cast<MazeGenerator::Algorithm>(header.algorithm)),
+                static_cast<unsigned long long>(header.seed), solution.size(), openMs, solveMs);
+
+    if (options.format == "none") return true;
+    std::filesystem::create_directories(options.output);
+    MazeThreadPool pool(options.threads);
+    std::string path = (std::filesystem::path(options.output) /
+                        std::filesystem::path(options.load).stem()).string() + "." + options.format;
+    bool ok = writeMaze(options, path, maze, solution, pool, header.algorithm, header.seed);
+    if (!ok) std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (!options.stream.empty()) {
+            if (!writeStream(options)) {
+                std::fprintf(stderr, "Failed to write %s\n", options.stream.c_str());
+                return 1;
+            }
+            return 0;
+        }
+        if (!options.load.empty()) {
+            return loadMaze(options) ? 0 : 1;
+        }
+
+        if (options.format != "none") {
+            std::filesystem::create_directories(options.output);
+        }
+
+        if (options.height > MazeGrid::kMaxDimension) {
+            throw std::invalid_argument("Invalid maze dimensions");
+        }
+        std::vector<MazeJob> jobs(options.count);
+        for (int i = 0; i < options.count; i++) {
+            jobs[i].width = options.width;
+            jobs[i].height = static_cast<int>(options.height);
+            jobs[i].algorithm = options.algorithm;
+            jobs[i].seed = options.seed + i;
+            jobs[i].tileSize = options.tileSize;
+            jobs[i].solve = options.solve;
+            jobs[i].solver = options.solver;
+        }
+
+        MazeThreadPool pool(options.threads);
+        MazeBatch batch(pool);
+        MazeCache cache;
+        if (!options.cache.empty()) {
+            cache.setDirectory(options.cache);
+            batch.setCache(&cache);
+        }
+        std::atomic<bool> failed(false);
+
+        if (!options.trace.empty()) MazeProfiler::get().startTrace();
+        auto t0 = std::chrono::steady_clock::now();
+        batch.run(jobs, [&](size_t index, const MazeGrid& maze,
+                            const std::vector<std::pair<int, int>>& solution) {
+            if (options.format == "none") return;
+            char name[32];
+            std::snprintf(name, sizeof(name), "maze_%05zu.%s", index, options.format.c_str());
+            std::string path = (std::filesystem::path(options.output) / name).string();
+            bool ok = writeMaze(options, path, maze, solution, pool,
+                                static_cast<uint32_t>(options.algorithm), options.seed + index);
+            if (!ok && !failed.exchange(true)) {
+                std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            }
+        });
+        double totalMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (!options.trace.empty() && !MazeProfiler::get().stopTrace(options.trace)) {
+            std::fprintf(stderr, "Failed to write %s\n", options.trace.c_str());
+            return 1;
+        }
+        if (failed) return 1;
+
+        std::printf("%d maze(s) %dx%lld, %s, seed %llu, %u thread(s): %.3f ms (%.1f mazes/s)\n",
+                    options.count, options.width, static_cast<long long>(options.height),
+                    MazeGenerator::getAlgorithmName(options.algorithm),
+                    static_cast<unsigned long long>(options.seed), pool.getThreadCount(),
+                    totalMs, totalMs > 0 ? options.count * 1000.0 / totalMs : 0.0);
+        if (!options.cache.empty()) {
+            std::printf("cache: %zu hit(s), %zu miss(es)\n", cache.getHitCount(), cache.getMissCount());
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
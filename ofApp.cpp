@@ -1,5 +1,4 @@
 #include "ofApp.h"
-#include <deque>
 #include <random>
 #include <chrono>
 
@@ -31,9 +30,11 @@ void ofApp::setup() {
     // Maze Settings group
     sizeControls.setName("Maze Settings");
     animationEnabled.set("Enable Animation", true);
+    stepsPerSecond.set("Steps / Second", 500, 0, 100000);  // 0 = as fast as the budget allows
     view3D.set("3D View", false);
     cellSizeGui.set("Cell Size", cellSize, 10, 50);
     sizeControls.add(animationEnabled);
+    sizeControls.add(stepsPerSecond);
     sizeControls.add(view3D);
     sizeControls.add(cellSizeGui);
     
@@ -74,6 +75,8 @@ void ofApp::setup() {
     algorithmGroup.add(algorithmRecursive);
     algorithmGroup.add(algorithmPrims);
     algorithmGroup.add(algorithmKruskals);
+    solverEngine.set("Solver Engine", 0, 0, static_cast<int>(MazeSolver::Algorithm::WALL_FOLLOWER));
+    algorithmGroup.add(solverEngine);
     
     // Add groups to GUI
     gui.add(sizeControls);
@@ -82,7 +85,11 @@ void ofApp::setup() {
     generateButton.addListener(this, &ofApp::onGeneratePressed);
     solveButton.addListener(this, &ofApp::onSolvePressed);
     
-    currentGenerationAlgorithm = GenerationAlgorithm::RECURSIVE_BACKTRACKER;
+    currentGenerationAlgorithm = MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER;
+    // Resize events below already build from these
+    mazeSeed = MazeRandom::randomSeed();
+    mazeAlgorithm = currentGenerationAlgorithm;
+    builder.setCache(&mazeCache);
     
     // Set initial window size
     ofSetWindowShape(1024, 768);
@@ -91,20 +98,14 @@ void ofApp::setup() {
     mazeWidth = 10;  // Start with fixed size for testing
     mazeHeight = 10;
     
-    // Initialize maze vector with proper dimensions
-    maze.resize(2 * mazeHeight + 1);
-    for (auto& row : maze) {
-        row.resize(2 * mazeWidth + 1, 1);
-    }
+    // Initialize maze grid with proper dimensions
+    maze.resize(mazeWidth, mazeHeight);
+    generator = make_unique<MazeGenerator>(mazeWidth, mazeHeight);
     // Initialize animation properties
     animatingGeneration = false;
     animatingSolution = false;
-    generationDelay = 50;  // milliseconds
-    solutionDelay = 100;   // milliseconds
-    lastUpdateTime = 0;
-    
-    // Initialize directions for maze generation
-    directions = {{0, 2}, {2, 0}, {0, -2}, {-2, 0}};
+    generationScheduler.setFrameBudget(0.008);  // seconds of each frame
+    solverScheduler.setFrameBudget(0.008);
     
     // Generate first maze
     resetMaze();
@@ -119,10 +120,12 @@ void ofApp::onGeneratePressed() {
             animatingGeneration = true;
             animatingSolution = false;
             showSolution = false;
-            current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-            current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-            unvisited = mazeWidth * mazeHeight - 1;
-            maze[current_y][current_x] = 0;
+            mazeSeed = MazeRandom::randomSeed();
+            mazeAlgorithm = currentGenerationAlgorithm;
+            generator->reset(maze, mazeSeed);
+            renderer.markSlotsDirty(generator->getChangedSlots());
+            generator->clearChangedSlots();
+            generationScheduler.restart();
         } else {
             // Instant generation
             animatingGeneration = false;
@@ -143,84 +146,81 @@ void ofApp::onSolvePressed() {
         showSolution = !showSolution;
         
         if (showSolution) {
-            // If showing solution and animation is enabled, start animation
+            // If showing solution and animation is enabled, watch the search
             if (animationEnabled) {
-                animatingSolution = true;
-                solution.clear();
-                solveMaze();
-                currentSolutionIndex = 0;
+                startSolveAnimation();
             } else {
                 // Just show the full solution without animation
-                solution.clear();
-                solveMaze();
                 animatingSolution = false;
+                solveMaze();
             }
         } else {
             // When hiding solution, stop any ongoing animation
             animatingSolution = false;
+            renderer.clearSearch();
         }
     }
 }
 
 //--------------------------------------------------------------
 void ofApp::update() {
-    float currentTime = ofGetElapsedTimeMillis();
+    MAZE_PROFILE_SCOPE("update");
+    swapInBuiltMaze();
     
     // Handle algorithm selection
-    if (algorithmRecursive && currentGenerationAlgorithm != GenerationAlgorithm::RECURSIVE_BACKTRACKER) {
+    auto previousAlgorithm = currentGenerationAlgorithm;
+    if (algorithmRecursive && currentGenerationAlgorithm != MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER) {
         algorithmPrims = false;
         algorithmKruskals = false;
-        currentGenerationAlgorithm = GenerationAlgorithm::RECURSIVE_BACKTRACKER;
-    } else if (algorithmPrims && currentGenerationAlgorithm != GenerationAlgorithm::PRIMS) {
+        currentGenerationAlgorithm = MazeGenerator::Algorithm::RECURSIVE_BACKTRACKER;
+    } else if (algorithmPrims && currentGenerationAlgorithm != MazeGenerator::Algorithm::PRIMS) {
         algorithmRecursive = false;
         algorithmKruskals = false;
-        currentGenerationAlgorithm = GenerationAlgorithm::PRIMS;
-    } else if (algorithmKruskals && currentGenerationAlgorithm != GenerationAlgorithm::KRUSKALS) {
+        currentGenerationAlgorithm = MazeGenerator::Algorithm::PRIMS;
+    } else if (algorithmKruskals && currentGenerationAlgorithm != MazeGenerator::Algorithm::KRUSKALS) {
         algorithmRecursive = false;
         algorithmPrims = false;
-        currentGenerationAlgorithm = GenerationAlgorithm::KRUSKALS;
+        currentGenerationAlgorithm = MazeGenerator::Algorithm::KRUSKALS;
+    }
+    generator->setAlgorithm(currentGenerationAlgorithm);
+    // Show the same seed carved by the new algorithm
+    if (currentGenerationAlgorithm != previousAlgorithm && !animatingGeneration) {
+        requestMaze();
     }
     
-    // Sync cell size with GUI
+    // Re-solve when a different solver engine is picked
+    auto solverAlgorithm = static_cast<MazeSolver::Algorithm>(solverEngine.get());
+    if (solverAlgorithm != solver.getAlgorithm()) {
+        solver.setAlgorithm(solverAlgorithm);
+        if (animatingSolution) {
+            startSolveAnimation();
+        } else if (!animatingGeneration) {
+            solveMaze();
+        }
+    }
+    
+    // Sync cell size with GUI; the old maze stays up until the new one is built
     if (cellSize != cellSizeGui) {
         cellSize = cellSizeGui;
-        updateMazeDimensions();
-        resetMaze();
-        generateMaze();
-        solveMaze();
+        requestMaze();
     }
     
-    if ((animatingGeneration || animatingSolution) && 
-        (currentTime - lastUpdateTime > (animatingGeneration ? generationDelay : solutionDelay))) {
+    // Both animations are paced by their schedulers, so they run every frame
+    if (animatingGeneration || animatingSolution) {
         updateAnimation();
-        lastUpdateTime = currentTime;
-    } else if (animatingSolution && !solution.empty()) {
-        // Animate solution path
-        if (currentSolutionIndex < static_cast<int>(solution.size())) {
-            currentSolutionIndex++;
-        } else {
-            animatingSolution = false;
-        }
     }
     
 }
 
 //--------------------------------------------------------------
 void ofApp::draw() {
+    MAZE_PROFILE_SCOPE("draw");
+    // Draw calls are counted per frame: the last frame's goes to the trace
+    // and counting restarts for this one
+    MazeProfiler::get().sampleCounters();
+    MAZE_PROFILE_SET(DRAW_CALLS, 0);
     ofBackground(33);  // Keep consistent dark background
     
-    // Update maze info
-    string info = "Maze Size: " + ofToString(mazeWidth) + "x" + ofToString(mazeHeight) + "\n";
-    info += "Cell Size: " + ofToString(cellSize) + "px\n";
-    info += "Generation Algorithm: ";
-    info += (algorithmRecursive ? "Recursive Backtracker" :
-             algorithmPrims ? "Prim's Algorithm" :
-             "Kruskal's Algorithm");
-    info += "\n";
-    info += animatingGeneration ? "Generating..." :
-    (animatingSolution ? "Solving..." : "Ready");
-    mazeInfo.set(info);
-    
     
     if (view3D) {
         // Basic 3D setup
@@ -269,249 +269,53 @@ void ofApp::draw() {
         ofSetColor(50);  // Darker floor for better contrast
         ofDrawRectangle(0, 0, (2 * mazeWidth + 1) * cellSize, (2 * mazeHeight + 1) * cellSize);
         
-        // Draw walls as a single solid structure
-        ofSetColor(100, 100, 120);  // Light gray-blue color for better contrast
-        ofMesh wallMesh;
-        wallMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+        // Cells reached by the solver search, just above the floor
+        renderer.drawSearch3D(maze, cellSize);
         
-        // Helper lambda to add a wall face (two triangles)
-        auto addWallFace = [&](const ofVec3f& bl, const ofVec3f& br, 
-                              const ofVec3f& tr, const ofVec3f& tl) {
-            int idx = wallMesh.getNumVertices();
-            wallMesh.addVertex(bl);
-            wallMesh.addVertex(br);
-            wallMesh.addVertex(tr);
-            wallMesh.addVertex(tl);
-            
-            // First triangle
-            wallMesh.addIndex(idx);
-            wallMesh.addIndex(idx + 1);
-            wallMesh.addIndex(idx + 2);
-            
-            // Second triangle
-            wallMesh.addIndex(idx);
-            wallMesh.addIndex(idx + 2);
-            wallMesh.addIndex(idx + 3);
-            
-            // Add normals for better lighting
-            ofVec3f normal = ((br - bl).getCrossed(tr - bl)).normalized();
-            for (int i = 0; i < 4; i++) {
-                wallMesh.addNormal(normal);
-            }
-        };
-        
-        for (int y = 0; y < 2 * mazeHeight + 1; y++) {
-            for (int x = 0; x < 2 * mazeWidth + 1; x++) {
-                if (maze[y][x] == 1) {
-                    float wx = x * cellSize;
-                    float wy = y * cellSize;
-                    float wz = 0;
-                    
-                    // Create vertices with a small offset to prevent z-fighting
-                    const float eps = 0.01f; // Increased offset to prevent z-fighting
-                    
-                    // Only create faces that are visible (not adjacent to another wall)
-                    bool hasWallNorth = (y > 0) && maze[y-1][x] == 1;
-                    bool hasWallSouth = (y < 2 * mazeHeight) && maze[y+1][x] == 1;
-                    bool hasWallEast = (x < 2 * mazeWidth) && maze[y][x+1] == 1;
-                    bool hasWallWest = (x > 0) && maze[y][x-1] == 1;
-
-                    // Create vertices for the wall cube with slight offsets
-                    ofVec3f frontBL(wx + eps, wy + eps, wz);
-                    ofVec3f frontBR(wx + cellSize - eps, wy + eps, wz);
-                    ofVec3f frontTR(wx + cellSize - eps, wy + eps, wz + wallHeight);
-                    ofVec3f frontTL(wx + eps, wy + eps, wz + wallHeight);
-                    
-                    ofVec3f backBL(wx + eps, wy + cellSize - eps, wz);
-                    ofVec3f backBR(wx + cellSize - eps, wy + cellSize - eps, wz);
-                    ofVec3f backTR(wx + cellSize - eps, wy + cellSize - eps, wz + wallHeight);
-                    ofVec3f backTL(wx + eps, wy + cellSize - eps, wz + wallHeight);
-                    
-                    // Only add faces that are visible, with proper depth testing
-                    if (!hasWallNorth) addWallFace(frontBL, frontBR, frontTR, frontTL); // Front
-                    if (!hasWallSouth) addWallFace(backBR, backBL, backTL, backTR);     // Back
-                    if (!hasWallEast) addWallFace(frontBR, backBR, backTR, frontTR);    // Right
-                    if (!hasWallWest) addWallFace(backBL, frontBL, frontTL, backTL);    // Left
-                    
-                    // Top face with slight inset to prevent z-fighting
-                    ofVec3f topFrontLeft = frontTL + ofVec3f(eps, eps, 0);
-                    ofVec3f topFrontRight = frontTR + ofVec3f(-eps, eps, 0);
-                    ofVec3f topBackRight = backTR + ofVec3f(-eps, -eps, 0);
-                    ofVec3f topBackLeft = backTL + ofVec3f(eps, -eps, 0);
-                    addWallFace(topFrontLeft, topFrontRight, topBackRight, topBackLeft); // Top always visible
-                }
-            }
-        }
-        
-        // Draw the entire maze as a single mesh
-        wallMesh.draw();
+        // Draw walls from the cached VBO, remeshed only after the maze changed
+        ofSetColor(100, 100, 120);  // Light gray-blue color for better contrast
+        renderer.drawWalls3D(maze, cellSize, wallHeight);
     } else {
-        // 2D view with consistent dark theme
-        for (int y = 0; y < 2 * mazeHeight + 1; y++) {
-            for (int x = 0; x < 2 * mazeWidth + 1; x++) {
-                if (maze[y][x] == 1) {
-                    ofSetColor(100, 100, 120);  // Same color as 3D walls
-                    drawCell(x, y, ofColor(100, 100, 120));
-                }
-            }
-        }
+        // 2D view: the maze, searched and shaded solution cells are one
+        // texture, the solution line is one line strip
+        renderer.draw2D(maze, solution, showSolution ? solution.size() : 0, cellSize);
     }
     
     // Draw current position during generation
     if (animatingGeneration) {
-        drawCell(current_x, current_y, ofColor(255, 0, 0, 128));  // Semi-transparent red
+        drawCell(generator->current_x, generator->current_y, ofColor(255, 0, 0, 128));  // Semi-transparent red
     }
     
     // Draw solution if enabled and exists
     if (showSolution && !solution.empty()) {
         if (view3D) {
-            // Draw solution path as a continuous tube
+            // Cached tube mesh, drawn once the search has found the path,
+            // in a single glow pass that also applies the path lights
+            int endIndex = solution.size();
+            // Set up blending for glow effect
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
             
-            // Draw solution path as a continuous tube
-            int endIndex = animatingSolution ? currentSolutionIndex : solution.size();
-            ofMesh tubeMesh;  // Moved outside the if block
-            if (endIndex > 1) {
-                tubeMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
-                const int segments = 8; // Number of segments around the tube
-                const float radius = cellSize/4;  // Much thicker tube
-                
-                for (size_t i = 0; i < endIndex - 1; i++) {
-                    const auto& current = solution[i];
-                    const auto& next = solution[i + 1];
-                    
-                    float x1 = (current.first + 0.5) * cellSize;
-                    float y1 = (current.second + 0.5) * cellSize;
-                    float x2 = (next.first + 0.5) * cellSize;
-                    float y2 = (next.second + 0.5) * cellSize;
-                    
-                    // Calculate direction vector
-                    ofVec3f dir(x2 - x1, y2 - y1, 0);
-                    ofVec3f up(0, 0, 1);
-                    ofVec3f right = dir.getCrossed(up).normalized();
-                    
-                    // Create circle points around the tube
-                    for (int s = 0; s <= segments; s++) {
-                        float angle = TWO_PI * s / segments;
-                        float cosA = cos(angle);
-                        float sinA = sin(angle);
-                        
-                        // Calculate points for both ends of this segment
-                        ofVec3f offset = right * (radius * cosA) + up * (radius * sinA);
-                        
-                        // Add vertices for both ends with proper height (lifted by half cell size)
-                        ofVec3f v1(x1, y1, cellSize);  // Lifted to cellSize instead of cellSize/2
-                        ofVec3f v2(x2, y2, cellSize);  // Lifted to cellSize instead of cellSize/2
-                        
-                        // Calculate normal vector for proper 3D appearance
-                        ofVec3f normal = offset.normalized();
-                        
-                        // Add height offset based on normal
-                        v1 += normal * radius;
-                        v2 += normal * radius;
-                        
-                        tubeMesh.addVertex(v1);
-                        tubeMesh.addVertex(v2);
-                        
-                        // Add color for both vertices
-                        ofFloatColor color(1.0, 0.55, 0.0);  // Golden orange
-                        tubeMesh.addColor(color);
-                        tubeMesh.addColor(color);
-                    }
-                }
-                
-                tubeMesh.draw();
-            }
-            // Apply glow effect and lights to the solution path
-            if (showSolution) {
-                // Update tube lights - limit to max 8 lights
-                tubeLights.clear();
-                size_t numLights = std::min(size_t(8), solution.size());
-                size_t step = solution.size() / numLights;
-                
-                for (size_t i = 0; i < numLights; i++) {
-                    size_t index = i * step;
-                    if (index >= endIndex) break;
-                    
-                    const auto& pos = solution[index];
-                    ofLight tubeLight;
-                    tubeLight.setup();
-                    tubeLight.enable();
-                    tubeLight.setPointLight();
-                    // Position light slightly above the tube
-                    tubeLight.setPosition(
-                        (pos.first + 0.5) * cellSize,
-                        (pos.second + 0.5) * cellSize,
-                        cellSize * 1.5  // Raised position
-                    );
-                    // Point light downward at the tube
-                    tubeLight.lookAt(ofVec3f(
-                        (pos.first + 0.5) * cellSize,
-                        (pos.second + 0.5) * cellSize,
-                        cellSize
-                    ));
-                    tubeLight.setDiffuseColor(ofColor(255, 140, 0, 200));  // Semi-transparent golden orange
-                    tubeLight.setSpecularColor(ofColor(255, 200, 0, 200));
-                    tubeLight.setAttenuation(0.5, 0.001, 0.0);  // Reduced attenuation for wider light spread
-                    tubeLight.setSpotlight();  // Use spotlight for more focused illumination
-                    tubeLight.setSpotlightCutOff(60);  // Wide angle for better coverage
-                    tubeLight.setSpotConcentration(2);  // Soft edge falloff
-                    tubeLights.push_back(tubeLight);
-                }
-
-                // Set up blending for glow effect
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-                
-                // Begin glow shader with enhanced parameters
-                glowShader.begin();
-                glowShader.setUniform3f("glowColor", 1.0, 0.65, 0.0); // Brighter golden orange
-                glowShader.setUniform1f("glowIntensity", 2.5); // Increased intensity
-                glowShader.setUniform1f("time", shaderTime);
-                
-                // Update shader time only when solution is visible
-                shaderTime += ofGetLastFrameTime() * 0.5; // Slower pulsing
-                
-                tubeMesh.draw();
-                
-                glowShader.end();
-                
-                // Reset OpenGL state
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-                glDisable(GL_BLEND);
-                
-                // Disable tube lights
-                for (auto& light : tubeLights) {
-                    light.disable();
-                }
-                tubeLights.clear();
-            } else {
-                // Draw without glow effect when solution is not visible
-                tubeMesh.draw();
-            }
-        } else {
-            // Draw solution path background
-            ofSetColor(255, 240, 240);  // Light red background
-            int endIndex = animatingSolution ? currentSolutionIndex : solution.size();
-            for (int i = 0; i < endIndex && i < solution.size(); i++) {
-                const auto& pos = solution[i];
-                drawCell(pos.first, pos.second, ofColor(255, 240, 240));
-            }
-            ofSetColor(255, 0, 0);  // Red path
-            ofSetLineWidth(cellSize/3);
+            // Begin glow shader with enhanced parameters
+            glowShader.begin();
+            glowShader.setUniform3f("baseColor", 1.0, 0.55, 0.0); // Golden orange
+            glowShader.setUniform3f("glowColor", 1.0, 0.65, 0.0); // Brighter golden orange
+            glowShader.setUniform1f("glowIntensity", 2.5); // Increased intensity
+            glowShader.setUniform1f("time", shaderTime);
+            // Emissive core plus the path lights sampled along the solution
+            glowShader.setUniform1f("emissive", 0.35);
+            renderer.applyPathLights(glowShader, endIndex);
             
-            // Draw lines connecting solution points
-            int lineEndIndex = animatingSolution ? currentSolutionIndex : solution.size();
-            for (size_t i = 0; i < lineEndIndex - 1 && i < solution.size() - 1; i++) {
-                const auto& current = solution[i];
-                const auto& next = solution[i + 1];
-                
-                float x1 = (current.first + 0.5) * cellSize;
-                float y1 = (current.second + 0.5) * cellSize;
-                float x2 = (next.first + 0.5) * cellSize;
-                float y2 = (next.second + 0.5) * cellSize;
-                
-                ofDrawLine(x1, y1, x2, y2);
-            }
+            // Update shader time only when solution is visible
+            shaderTime += ofGetLastFrameTime() * 0.5; // Slower pulsing
+            
+            renderer.drawSolutionTube(solution, endIndex, cellSize);
+            
+            glowShader.end();
+            
+            // Reset OpenGL state
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDisable(GL_BLEND);
         }
         
     }
@@ -522,6 +326,27 @@ void ofApp::draw() {
         ofDisableDepthTest();
     }
     
+    // Update maze info, once the scene's draw calls are counted
+    string info = "Maze Size: " + ofToString(mazeWidth) + "x" + ofToString(mazeHeight) + "\n";
+    info += "Cell Size: " + ofToString(cellSize) + "px\n";
+    info += "Seed: " + ofToString(mazeSeed) + "\n";
+    info += "Generation Algorithm: ";
+    info += MazeGenerator::getAlgorithmName(currentGenerationAlgorithm);
+    info += "\n";
+    info += "Solver: ";
+    info += MazeSolver::getAlgorithmName(solver.getAlgorithm());
+    info += "\n";
+    if (view3D) {
+        info += "Chunks: " + ofToString(renderer.getVisibleChunkCount()) + " visible ("
+            + ofToString(renderer.getFlatChunkCount()) + " flat) of "
+            + ofToString(renderer.getChunkCount()) + "\n";
+    }
+    info += builder.isBusy() ? "Building..." :
+    (animatingGeneration ? "Generating..." :
+    (animatingSolution ? "Solving..." : "Ready"));
+    info += "\n" + profileInfo();
+    mazeInfo.set(info);
+    
     // Draw GUI if enabled (now on top of everything)
     if (showGui) {
         ofSetColor(255);  // Ensure GUI is drawn in white
@@ -551,18 +376,18 @@ void ofApp::keyPressed(int key) {
     } else if (key == 'f') {  // 'f' toggles animated solution
         if (!animatingGeneration) {
             if (!animatingSolution) {
-                animatingSolution = true;
                 showSolution = true;
-                solution.clear();
-                solveMaze();
-                currentSolutionIndex = 0;
+                startSolveAnimation();
             } else {
+                // Stop watching and finish the search at once
                 animatingSolution = false;
+                solveMaze();
             }
         }
     } else if (key == 's') {  // 's' toggles solution visibility
         showSolution = !showSolution;
         animatingSolution = false;  // Stop any ongoing solution animation
+        renderer.clearSearch();
     } else if (key == '+' || key == '=') {  // Increase cell size
         cellSizeGui = min(50, cellSize + 2);
         cellSize = cellSizeGui;
@@ -573,126 +398,42 @@ void ofApp::keyPressed(int key) {
         needsUpdate = true;
     } else if (key == 'h') {  // Toggle GUI
         showGui = !showGui;
+    } else if (key == 'w') {  // 'w' writes the maze to a .maze file
+        saveMazeFile();
+    } else if (key == 'o') {  // 'o' opens a .maze file
+        openMazeFile();
+    } else if (key == 't') {  // 't' starts / stops recording a trace
+        toggleTrace();
     }
     
     if (needsUpdate) {
-        updateMazeDimensions();
-        resetMaze();
-        generateMaze();
-        solveMaze();
+        requestMaze();
     }
 }
 
 //--------------------------------------------------------------
 void ofApp::generateMaze() {
-    // Start with all walls
-    for (int y = 0; y < 2 * mazeHeight + 1; y++) {
-        for (int x = 0; x < 2 * mazeWidth + 1; x++) {
-            maze[y][x] = 1;
-        }
-    }
-    
-    // Start at a random cell
-    int current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-    int current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-    maze[current_y][current_x] = 0;
-    
-    int unvisited = mazeWidth * mazeHeight - 1;
-    vector<pair<int, int>> directions = {{0, 2}, {2, 0}, {0, -2}, {-2, 0}};
-    
-    while (unvisited > 0) {
-        // Pick a random direction
-        int dir_idx = static_cast<int>(ofRandom(4));
-        int dx = directions[dir_idx].first;
-        int dy = directions[dir_idx].second;
-        int next_x = current_x + dx;
-        int next_y = current_y + dy;
-        
-        // Check if the next cell is valid and unvisited
-        if (next_x > 0 && next_x < 2 * mazeWidth && 
-            next_y > 0 && next_y < 2 * mazeHeight && 
-            maze[next_y][next_x] == 1) {
-            // Carve a passage
-            maze[(current_y + next_y) / 2][(current_x + next_x) / 2] = 0;  // Remove wall
-            maze[next_y][next_x] = 0;  // Mark cell as visited
-            unvisited--;
-            current_x = next_x;
-            current_y = next_y;
-        } else {
-            // If we hit a wall or visited cell, randomly jump to a visited cell
-            do {
-                current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-                current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-            } while (maze[current_y][current_x] == 1);
-        }
-    }
-    
-    // Create entrance and exit
-    maze[0][1] = 0;  // Entrance at top
-    maze[2 * mazeHeight][2 * mazeWidth - 1] = 0;  // Exit at bottom
-    
-    // Ensure the cells next to entrance/exit are open
-    maze[1][1] = 0;  // Cell after entrance
-    maze[2 * mazeHeight - 1][2 * mazeWidth - 1] = 0;  // Cell before exit
+    mazeSeed = MazeRandom::randomSeed();
+    mazeAlgorithm = currentGenerationAlgorithm;
+    generator->generate(maze, mazeSeed);
+    renderer.markDirty();
 }
 
 //--------------------------------------------------------------
-bool ofApp::isValid(int x, int y) {
-    // Check bounds for the entire maze including walls
-    return x >= 0 && x < (2 * mazeWidth + 1) && 
-           y >= 0 && y < (2 * mazeHeight + 1);
+void ofApp::solveMaze() {
+    solver.solve(maze);
+    solution = solver.getSolution();
+    renderer.markSolutionDirty();
+    renderer.clearSearch();
 }
 
-//--------------------------------------------------------------
-void ofApp::solveMaze() {
+void ofApp::startSolveAnimation() {
+    animatingSolution = true;
     solution.clear();
-    
-    // Start from entrance, end at exit
-    pair<int, int> start = {1, 0};
-    pair<int, int> end = {2 * mazeWidth - 1, 2 * mazeHeight};
-    
-    // BFS queue and visited set
-    deque<pair<pair<int, int>, vector<pair<int, int>>>> queue;
-    set<pair<int, int>> visited;
-    
-    // Initialize with start position
-    queue.push_back({start, {start}});
-    visited.insert(start);
-    
-    // Possible moves: down, right, up, left
-    vector<pair<int, int>> moves = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-    
-    while (!queue.empty()) {
-        auto current = queue.front().first;
-        auto path = queue.front().second;
-        queue.pop_front();
-        
-        // Check if we reached the exit
-        if (current == end) {
-            solution = path;
-            return;
-        }
-        
-        // Try all possible moves
-        for (const auto& move : moves) {
-            int next_x = current.first + move.first;
-            int next_y = current.second + move.second;
-            
-            // Check if the move is valid
-            if (isValid(next_x, next_y) && 
-                maze[next_y][next_x] == 0 && 
-                visited.find({next_x, next_y}) == visited.end()) {
-                
-                // Create new path with this move
-                auto new_path = path;
-                new_path.push_back({next_x, next_y});
-                
-                // Add to queue and mark as visited
-                queue.push_back({{next_x, next_y}, new_path});
-                visited.insert({next_x, next_y});
-            }
-        }
-    }
+    renderer.markSolutionDirty();
+    renderer.clearSearch();
+    solver.begin(maze);
+    solverScheduler.restart();
 }
 
 //--------------------------------------------------------------
@@ -704,81 +445,190 @@ void ofApp::drawCell(int x, int y, const ofColor& color) {
 
 //--------------------------------------------------------------
 void ofApp::resetMaze() {
-    // Ensure maze vector has correct size before accessing
-    if (maze.size() != 2 * mazeHeight + 1) {
-        maze.resize(2 * mazeHeight + 1);
-    }
-    for (int y = 0; y < 2 * mazeHeight + 1; y++) {
-        if (maze[y].size() != 2 * mazeWidth + 1) {
-            maze[y].resize(2 * mazeWidth + 1);
-        }
-        for (int x = 0; x < 2 * mazeWidth + 1; x++) {
-            maze[y][x] = 1;
-        }
+    // Ensure maze grid has correct size before accessing
+    if (maze.getWidth() != mazeWidth || maze.getHeight() != mazeHeight) {
+        maze.resize(mazeWidth, mazeHeight);
+    } else {
+        maze.fill(true);
     }
+    renderer.markDirty();
+    renderer.markSolutionDirty();
     solution.clear();
+    animatingSolution = false;  // the search was over the old grid
+    builder.cancel();  // a pending resize would overwrite this maze
 }
 void ofApp::windowResized(int w, int h) {
-    updateMazeDimensions();
-    resetMaze();
-    generateMaze();
-    solveMaze();
+    requestMaze();
 }
 
-void ofApp::updateMazeDimensions() {
+void ofApp::requestMaze() {
     // Calculate new dimensions with bounds checking
-    int newWidth = std::clamp((ofGetWidth() / cellSize - 1) / 2, 5, 100);
-    int newHeight = std::clamp((ofGetHeight() / cellSize - 1) / 2, 5, 100);
+    MazeJob job;
+    job.width = std::clamp((ofGetWidth() / cellSize - 1) / 2, 5, 100);
+    job.height = std::clamp((ofGetHeight() / cellSize - 1) / 2, 5, 100);
+    job.algorithm = currentGenerationAlgorithm;
+    job.seed = mazeSeed;
+    job.solver = solver.getAlgorithm();
+    
+    rememberMaze();
+    // Animations belong to the maze being replaced
+    animatingGeneration = false;
+    animatingSolution = false;
+    if (mazeCache.get(job, nextMaze.maze, nextMaze.solution) && !nextMaze.solution.empty()) {
+        builder.cancel();
+        showMaze(job);
+        return;
+    }
+    // Misses, and hits stored without a solution, are built (or only
+    // solved) off the render thread
+    builder.request(job);
+}
+
+void ofApp::swapInBuiltMaze() {
+    MazeJob job;
+    if (builder.takeResult(nextMaze, &job)) {
+        showMaze(job);
+    }
+}
+
+void ofApp::showMaze(const MazeJob& job) {
+    // O(1) swap of the finished grid and solution into the front buffer
+    std::swap(maze, nextMaze.maze);
+    solution.swap(nextMaze.solution);
+    mazeWidth = job.width;
+    mazeHeight = job.height;
+    mazeSeed = job.seed;
+    mazeAlgorithm = job.algorithm;
+    generator->setSize(mazeWidth, mazeHeight);
+    renderer.markDirty();
+    renderer.markSolutionDirty();
+}
+
+void ofApp::rememberMaze() {
+    // Half-carved mazes and loaded files are not what their key would build
+    if (animatingGeneration || maze.empty() || maze.isView()) return;
+    MazeJob job;
+    job.width = maze.getWidth();
+    job.height = maze.getHeight();
+    job.algorithm = mazeAlgorithm;
+    job.seed = mazeSeed;
+    mazeCache.put(job, maze, animatingSolution ? vector<pair<int, int>>() : solution);
+}
+
+//--------------------------------------------------------------
+void ofApp::saveMazeFile() {
+    ofFileDialogResult result = ofSystemSaveDialog("maze.maze", "Save maze");
+    if (!result.bSuccess) return;
+    if (!MazeFile::save(result.getPath(), maze, static_cast<uint32_t>(mazeAlgorithm),
+                        mazeSeed, solution)) {
+        ofLogError("ofApp") << "Failed to write " << result.getPath();
+    }
+}
+
+void ofApp::openMazeFile() {
+    ofFileDialogResult result = ofSystemLoadDialog("Open maze");
+    if (!result.bSuccess) return;
+    // Checked through a separate mapping first: the front buffer may view
+    // the current file, which has to stay open if this one is rejected
+    string path = result.getPath();
+    MazeFile probe;
+    try {
+        probe.open(path);
+    } catch (const std::exception& e) {
+        ofLogError("ofApp") << e.what();
+        return;
+    }
+    if (!probe.verify()) {
+        ofLogError("ofApp") << "Checksum mismatch in " << path;
+        return;
+    }
+    // The cache and later saves key the maze by its algorithm
+    uint32_t algorithm = probe.getHeader().algorithm;
+    if (algorithm > static_cast<uint32_t>(MazeGenerator::Algorithm::ELLERS)) {
+        ofLogError("ofApp") << "Unknown generation algorithm in " << path;
+        return;
+    }
+    probe.close();
+    try {
+        mazeFile.open(path);
+    } catch (const std::exception& e) {
+        ofLogError("ofApp") << e.what();
+        return;
+    }
     
-    // Only update if dimensions have changed
-    if (newWidth != mazeWidth || newHeight != mazeHeight) {
-        mazeWidth = newWidth;
-        mazeHeight = newHeight;
-        
-        // Properly resize both dimensions of the vector
-        maze.resize(2 * mazeHeight + 1);
-        for (auto& row : maze) {
-            row.resize(2 * mazeWidth + 1, 1);
+    // A pending resize would replace the loaded maze
+    builder.cancel();
+    animatingGeneration = false;
+    animatingSolution = false;
+    // Zero-copy: the front buffer views the mapped file
+    maze = std::move(mazeFile.getGrid());
+    mazeWidth = maze.getWidth();
+    mazeHeight = maze.getHeight();
+    mazeSeed = mazeFile.getHeader().seed;
+    mazeAlgorithm = static_cast<MazeGenerator::Algorithm>(algorithm);
+    generator->setSize(mazeWidth, mazeHeight);
+    renderer.markDirty();
+    if (mazeFile.readSolution(solution) && !solution.empty()) {
+        renderer.markSolutionDirty();
+    } else {
+        if (mazeFile.hasSolution()) {
+            ofLogWarning("ofApp") << "Ignoring the stored solution, which leaves the maze";
         }
-        
-        // Clear solution when dimensions change
-        solution.clear();
+        solveMaze();
     }
 }
+
+//--------------------------------------------------------------
+string ofApp::profileInfo() {
+    MazeProfiler& profiler = MazeProfiler::get();
+    string info = "Phase ms (last / max):\n";
+    for (const auto& phase : profiler.getPhases()) {
+        if (phase.calls == 0) continue;
+        info += "  " + string(phase.name) + ": " + ofToString(phase.lastMs, 2) + " / "
+            + ofToString(phase.maxMs, 2) + "\n";
+    }
+    for (int i = 0; i < MazeProfiler::COUNTER_COUNT; i++) {
+        auto counter = static_cast<MazeProfiler::Counter>(i);
+        info += string(MazeProfiler::getCounterName(counter)) + ": "
+            + ofToString(profiler.getCounter(counter)) + "\n";
+    }
+    if (profiler.isTracing()) info += "Recording trace (T to stop)\n";
+    return info;
+}
+
+void ofApp::toggleTrace() {
+    MazeProfiler& profiler = MazeProfiler::get();
+    if (!profiler.isTracing()) {
+        profiler.startTrace();
+        return;
+    }
+    string path = ofToDataPath("maze_trace.json", true);
+    if (profiler.stopTrace(path)) {
+        ofLogNotice("ofApp") << "Wrote trace " << path;
+    } else {
+        ofLogError("ofApp") << "Failed to write " << path;
+    }
+}
+
 void ofApp::updateAnimation() {
     if (animatingGeneration) {
-        if (unvisited > 0) {
-            // Pick a random direction
-            int dir_idx = static_cast<int>(ofRandom(4));
-            int dx = directions[dir_idx].first;
-            int dy = directions[dir_idx].second;
-            int next_x = current_x + dx;
-            int next_y = current_y + dy;
-            
-            // Check if the next cell is valid and unvisited
-            if (next_x > 0 && next_x < 2 * mazeWidth && 
-                next_y > 0 && next_y < 2 * mazeHeight && 
-                maze[next_y][next_x] == 1) {
-                // Carve a passage
-                maze[(current_y + next_y) / 2][(current_x + next_x) / 2] = 0;
-                maze[next_y][next_x] = 0;
-                unvisited--;
-                current_x = next_x;
-                current_y = next_y;
-            } else {
-                // If we hit a wall or visited cell, randomly jump to a visited cell
-                do {
-                    current_x = 2 * (static_cast<int>(ofRandom(mazeWidth))) + 1;
-                    current_y = 2 * (static_cast<int>(ofRandom(mazeHeight))) + 1;
-                } while (maze[current_y][current_x] == 1);
-            }
-        } else {
-            // Finish generation
-            maze[0][1] = 0;  // Create entrance
-            maze[2 * mazeHeight][2 * mazeWidth - 1] = 0;  // Create exit
-            maze[1][1] = 0;  // Ensure entrance path
-            maze[2 * mazeHeight - 1][2 * mazeWidth - 1] = 0;  // Ensure exit path
+        generationScheduler.setStepsPerSecond(stepsPerSecond);
+        generationScheduler.run([this] { return generator->step(maze); });
+        renderer.markSlotsDirty(generator->getChangedSlots());
+        generator->clearChangedSlots();
+        if (!generator->isAnimating()) {
             animatingGeneration = false;
         }
+    } else if (animatingSolution) {
+        // The frontier and visited cells are painted as the search runs
+        solverScheduler.setStepsPerSecond(stepsPerSecond);
+        solverScheduler.run([this] { return solver.step(maze); });
+        renderer.markSearchDirty(solver.getSearchMarks());
+        solver.clearSearchMarks();
+        if (!solver.isSearching()) {
+            solution = solver.getSolution();
+            renderer.markSolutionDirty();
+            animatingSolution = false;
+        }
     }
 }
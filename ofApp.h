@@ -2,6 +2,15 @@
 
 #include "ofMain.h"
 #include "ofxGui.h"
+#include "MazeGrid.h"
+#include "MazeGenerator.h"
+#include "MazeAsyncBuilder.h"
+#include "MazeCache.h"
+#include "MazeFile.h"
+#include "MazeProfiler.h"
+#include "MazeSolver.h"
+#include "MazeRenderer.h"
+#include "MazeStepScheduler.h"
 
 class ofApp : public ofBaseApp {
 public:
@@ -16,27 +25,43 @@ public:
     int mazeWidth;
     int mazeHeight;
     
-    vector<vector<int>> maze;
+    MazeGrid maze;
     vector<pair<int, int>> solution;
     
     // Animation properties
     bool animatingGeneration;
     bool animatingSolution;
-    int generationDelay;
-    int solutionDelay;
-    float lastUpdateTime;
-    int currentSolutionIndex;
+    // Run as many generator / solver steps per frame as the rate and
+    // budget allow
+    MazeStepScheduler generationScheduler;
+    MazeStepScheduler solverScheduler;
     
-    // Generation animation state
-    int current_x;
-    int current_y;
-    int unvisited;
-    vector<pair<int, int>> directions;
+    // Generation engine, created once in setup() and resized with setSize()
+    // when the maze dimensions change
+    unique_ptr<MazeGenerator> generator;
+    MazeSolver solver;
+    uint64_t mazeSeed;
+    // Algorithm the current maze was generated with
+    MazeGenerator::Algorithm mazeAlgorithm;
+    // Mazes already seen, by size, algorithm and seed; resizes keep the
+    // seed, so going back to an earlier size is a cache hit. Declared
+    // before the builder, whose thread uses it.
+    MazeCache mazeCache;
+    // Cached GPU geometry, rebuilt only when the maze changes
+    MazeRenderer renderer;
+    // Resizes are generated and solved off the render thread; the finished
+    // maze and solution are swapped in from nextMaze
+    MazeAsyncBuilder builder;
+    MazeResult nextMaze;
+    // A loaded maze is a view of this mapping, which stays open until the
+    // next file is loaded
+    MazeFile mazeFile;
     
     // Maze generation methods
     void generateMaze();
-    bool isValid(int x, int y);
     void solveMaze();
+    // Step the solver on screen instead of solving at once
+    void startSolveAnimation();
     
     // Helper methods
     void drawCell(int x, int y, const ofColor& color);
@@ -47,7 +72,19 @@ public:
     
 private:
     bool showSolution;
-    void updateMazeDimensions();
+    // Queue a new maze sized to the window and cell size
+    void requestMaze();
+    void swapInBuiltMaze();
+    // Swap nextMaze, built for job, into the front buffer
+    void showMaze(const MazeJob& job);
+    // Cache the current maze before it is replaced
+    void rememberMaze();
+    void saveMazeFile();
+    void openMazeFile();
+    // Phase times and counters for the Maze Info panel
+    string profileInfo();
+    // Start recording a trace, or write the one being recorded
+    void toggleTrace();
     void onGeneratePressed();
     void onSolvePressed();
     
@@ -55,13 +92,13 @@ private:
     ofxPanel gui;
     ofParameter<bool> showGui;
     ofParameter<bool> animationEnabled;
+    ofParameter<int> stepsPerSecond;
     ofParameter<bool> view3D;
     ofParameter<string> mazeInfo;
     ofEasyCam cam;
     float wallHeight;
     ofLight pointLight;
     ofLight directionalLight;
-    vector<ofLight> tubeLights;  // Array of lights for the solution path
     ofShader glowShader;
     float shaderTime;
     ofParameter<int> cellSizeGui;
@@ -70,14 +107,9 @@ private:
     ofParameter<bool> algorithmRecursive;
     ofParameter<bool> algorithmPrims;
     ofParameter<bool> algorithmKruskals;
+    ofParameter<int> solverEngine;
     ofxButton generateButton;
     ofxButton solveButton;
     
-    // Algorithm types
-    enum class GenerationAlgorithm {
-        RECURSIVE_BACKTRACKER,
-        PRIMS,
-        KRUSKALS
-    };
-    GenerationAlgorithm currentGenerationAlgorithm;
+    MazeGenerator::Algorithm currentGenerationAlgorithm;
 };
@@ -0,0 +1,111 @@
+#include "MazeGenerator.h"
+#include "MazeSolver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Solver checks, run by ctest. Exits non-zero after printing every failure.
+
+namespace {
+
+typedef std::pair<int, int> Slot;
+
+const MazeSolver::Algorithm kShortestSolvers[] = {
+    MazeSolver::Algorithm::BFS,
+    MazeSolver::Algorithm::BIDIRECTIONAL_BFS,
+    MazeSolver::Algorithm::A_STAR,
+    MazeSolver::Algorithm::DEAD_END_FILLING,
+};
+
+// Slots on the shortest route from start to goal, by a plain BFS over slots
+size_t shortestLength(const MazeGrid& maze, Slot start, Slot goal) {
+    int width = maze.getSlotWidth();
+    std::vector<size_t> length(static_cast<size_t>(width) * maze.getSlotHeight(), 0);
+    std::queue<Slot> queue;
+    length[start.second * width + start.first] = 1;
+    queue.push(start);
+    while (!queue.empty()) {
+        Slot slot = queue.front();
+        queue.pop();
+        size_t here = length[slot.second * width + slot.first];
+        if (slot == goal) return here;
+        for (int dir = 0; dir < 4; dir++) {
+            int x = slot.first + MazeGrid::kDirX[dir];
+            int y = slot.second + MazeGrid::kDirY[dir];
+            if (!maze.inBounds(x, y) || maze.isWall(x, y) || length[y * width + x]) continue;
+            length[y * width + x] = here + 1;
+            queue.push({x, y});
+        }
+    }
+    return 0;
+}
+
+bool isRoute(const MazeGrid& maze, const std::vector<Slot>& route, Slot start, Slot goal) {
+    if (route.empty() || route.front() != start || route.back() != goal) return false;
+    for (size_t i = 0; i < route.size(); i++) {
+        if (maze.isWall(route[i].first, route[i].second)) return false;
+        if (i > 0 && std::abs(route[i].first - route[i - 1].first) +
+                             std::abs(route[i].second - route[i - 1].second) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Braided mazes with both endpoints on passage slots: every shortest-path
+// solver must return a route of the optimal length
+int testBraidedPassageEndpoints() {
+    int failures = 0;
+    std::mt19937 random(5);
+    MazeGenerator generator(1, 1);
+    for (int round = 0; round < 200; round++) {
+        int width = 2 + random() % 15;
+        int height = 2 + random() % 15;
+        generator.setSize(width, height);
+        MazeGrid maze;
+        generator.generate(maze, round);
+
+        // Knock out walls between cells to open loops, and collect passages
+        for (int i = 0; i < width * height / 2; i++) {
+            int x = 1 + random() % (2 * width - 1);
+            int y = 1 + random() % (2 * height - 1);
+            if ((x + y) % 2 == 1) maze.carve(x, y);
+        }
+        std::vector<Slot> passages;
+        for (int y = 1; y < maze.getSlotHeight() - 1; y++) {
+            for (int x = 1; x < maze.getSlotWidth() - 1; x++) {
+                if ((x + y) % 2 == 1 && maze.isOpen(x, y)) passages.push_back({x, y});
+            }
+        }
+
+        for (int pair = 0; pair < 10; pair++) {
+            Slot start = passages[random() % passages.size()];
+            Slot goal = passages[random() % passages.size()];
+            size_t expected = shortestLength(maze, start, goal);
+            for (MazeSolver::Algorithm algorithm : kShortestSolvers) {
+                MazeSolver solver(algorithm);
+                solver.solve(maze, start, goal);
+                const std::vector<Slot>& route = solver.getSolution();
+                if (isRoute(maze, route, start, goal) && route.size() == expected) continue;
+                std::printf("%s, %dx%d maze %d, (%d, %d) to (%d, %d): %zu slots, expected %zu\n",
+                            MazeSolver::getAlgorithmName(algorithm), width, height, round,
+                            start.first, start.second, goal.first, goal.second, route.size(),
+                            expected);
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+}  // namespace
+
+int main() {
+    int failures = testBraidedPassageEndpoints();
+    if (failures) std::printf("%d failure(s)\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}